@@ -0,0 +1,118 @@
+#include "concurrency/mpmc_queue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// the mutex + condition variable queue the pipeline stages used so far, bounded the same way
+template <typename T>
+class MutexQueue {
+ public:
+  explicit MutexQueue(size_t capacity) : capacity_(capacity) {}
+
+  void push(T value) {
+    std::unique_lock<std::mutex> guard(lock_);
+    not_full_.wait(guard, [this]() { return items_.size() < capacity_; });
+    items_.push_back(std::move(value));
+    not_empty_.notify_one();
+  }
+
+  void pop(T &value) {
+    std::unique_lock<std::mutex> guard(lock_);
+    not_empty_.wait(guard, [this]() { return !items_.empty(); });
+    value = std::move(items_.front());
+    items_.pop_front();
+    not_full_.notify_one();
+  }
+
+ private:
+  size_t capacity_;
+  std::mutex lock_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::deque<T> items_;
+};
+
+// seconds to move item_count items from producer_count producers to consumer_count consumers;
+// batch > 1 uses push_n/pop_n (MpmcQueue only)
+template <typename Queue>
+static double transfer_benchmark(Queue &queue, int producer_count, int consumer_count, int item_count,
+                                 size_t batch = 1) {
+  std::vector<std::thread> threads;
+  auto start_time = std::chrono::high_resolution_clock::now();
+  for (int p = 0; p < producer_count; p++) {
+    int begin = item_count / producer_count * p;
+    int end = p == producer_count - 1 ? item_count : item_count / producer_count * (p + 1);
+    threads.emplace_back([&queue, begin, end, batch]() {
+      if constexpr (std::is_same_v<Queue, hstl::MpmcQueue<uint64_t>>) {
+        if (batch > 1) {
+          std::vector<uint64_t> values;
+          for (int i = begin; i < end; i += static_cast<int>(batch)) {
+            values.clear();
+            for (int k = i; k < end && k < i + static_cast<int>(batch); k++) {
+              values.push_back(static_cast<uint64_t>(k));
+            }
+            queue.push_n(values.begin(), values.size());
+          }
+          return;
+        }
+      }
+      for (int i = begin; i < end; i++) {
+        queue.push(static_cast<uint64_t>(i));
+      }
+    });
+  }
+  for (int c = 0; c < consumer_count; c++) {
+    int share = item_count / consumer_count + (c < item_count % consumer_count ? 1 : 0);
+    threads.emplace_back([&queue, share, batch]() {
+      uint64_t sum = 0;
+      if constexpr (std::is_same_v<Queue, hstl::MpmcQueue<uint64_t>>) {
+        if (batch > 1) {
+          std::vector<uint64_t> values;
+          for (int got = 0; got < share;) {
+            values.clear();
+            got += static_cast<int>(queue.pop_n(std::back_inserter(values), std::min<size_t>(batch, share - got)));
+            for (auto v : values) {
+              sum += v;
+            }
+          }
+          return;
+        }
+      }
+      for (int i = 0; i < share; i++) {
+        uint64_t v;
+        queue.pop(v);
+        sum += v;
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  auto end_time = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count();
+}
+
+int main() {
+  const int item_count = 1000000;
+  const size_t capacity = 1024;
+  std::vector<std::pair<int, int>> configs = {{1, 1}, {1, 4}, {4, 1}, {2, 2}, {4, 4}, {8, 8}};
+  for (auto [producers, consumers] : configs) {
+    MutexQueue<uint64_t> mutex_queue(capacity);
+    hstl::MpmcQueue<uint64_t> mpmc_queue(capacity);
+    hstl::MpmcQueue<uint64_t> batch_queue(capacity);
+    std::cout << "producers: " << producers << ", consumers: " << consumers << ", items: " << item_count
+              << ", mutex queue: " << transfer_benchmark(mutex_queue, producers, consumers, item_count)
+              << ", mpmc queue: " << transfer_benchmark(mpmc_queue, producers, consumers, item_count)
+              << ", mpmc queue batches of 32: "
+              << transfer_benchmark(batch_queue, producers, consumers, item_count, 32) << std::endl;
+  }
+}
@@ -0,0 +1,60 @@
+#include "concurrency/parallel_sort.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+template <typename T>
+static std::vector<T> random_values(size_t n) {
+  std::mt19937_64 gen(n);
+  std::uniform_real_distribution<double> real(0, 1e9);
+  std::vector<T> v(n);
+  for (auto &x : v) {
+    if constexpr (std::is_integral_v<T>) {
+      x = static_cast<T>(gen());
+    } else {
+      x = static_cast<T>(real(gen));
+    }
+  }
+  return v;
+}
+
+// seconds for sorting a copy of values with sort
+template <typename T, typename Sort>
+static double sort_benchmark(const std::vector<T> &values, Sort &&sort) {
+  auto v = values;
+  auto start_time = std::chrono::high_resolution_clock::now();
+  sort(v);
+  auto end_time = std::chrono::high_resolution_clock::now();
+  if (!std::is_sorted(v.begin(), v.end())) {
+    std::cout << "not sorted!" << std::endl;
+  }
+  return std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count();
+}
+
+template <typename T>
+static void compare(const char *type, hstl::ThreadPool &pool, size_t n) {
+  auto values = random_values<T>(n);
+  double std_time = sort_benchmark(values, [](std::vector<T> &v) { std::sort(v.begin(), v.end()); });
+  double parallel_time = sort_benchmark(values, [&pool](std::vector<T> &v) {
+    hstl::parallel_sort(pool, v.begin(), v.end());
+  });
+  std::cout << "type: " << type << ", size: " << n << ", thread_count: " << pool.size()
+            << ", std::sort: " << std_time << ", parallel_sort: " << parallel_time
+            << ", speedup: " << std_time / parallel_time << std::endl;
+}
+
+int main() {
+  size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+  hstl::ThreadPool pool(thread_count);
+
+  for (size_t n : {10000, 100000, 1000000, 10000000, 100000000}) {
+    compare<uint32_t>("uint32_t", pool, n);
+    compare<int64_t>("int64_t", pool, n);
+    compare<double>("double", pool, n);
+  }
+}
@@ -1,9 +1,34 @@
+#include "concurrency/coroutine.hpp"
+#include "concurrency/task_group.hpp"
 #include "concurrency/thread_pool.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdlib>
 #include <future>
+#include <new>
+#include <stdexcept>
 #include <vector>
 #include <iostream>
+#include <thread>
+#include <tuple>
+
+// count every heap allocation of the process. The replacements are not inlined: GCC would
+// otherwise see free() called on what it takes for the library's operator new
+// (-Wmismatched-new-delete)
+static std::atomic<size_t> allocation_count(0);
+
+__attribute__((noinline)) void* operator new(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { ::operator delete(p); }
 
 static double lock_contention_benchmark(int thread_count, int task_count) {
   using namespace std::chrono_literals;
@@ -25,13 +50,409 @@ static double lock_contention_benchmark(int thread_count, int task_count) {
   return std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count();
 }
 
+// producer_count threads submit task_count tasks in total
+static double multi_producer_benchmark(int thread_count, int producer_count, int task_count) {
+  auto add = [](int a, int b) { return a + b; };
+
+  hstl::ThreadPool pool(thread_count);
+
+  std::vector<std::future<int>> res(task_count);
+  std::vector<std::thread> producers(producer_count);
+  int per_producer = task_count / producer_count;
+
+  auto start_time = std::chrono::high_resolution_clock::now();
+  for (int p = 0; p < producer_count; p++) {
+    producers[p] = std::thread([&, p]() {
+      for (int i = p * per_producer; i < (p + 1) * per_producer; i++) {
+        res[i] = pool.submit(add, i, i);
+      }
+    });
+  }
+  for (auto &t : producers) {
+    t.join();
+  }
+
+  for (int i = 0; i < per_producer * producer_count; i++) {
+    res[i].get();
+  }
+  auto end_time = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count();
+}
+
+// the same tasks as lock_contention_benchmark submitted in one submit_n call
+static double batch_benchmark(int thread_count, int task_count) {
+  auto add = [](int a, int b) { return a + b; };
+
+  hstl::ThreadPool pool(thread_count);
+
+  std::vector<int> res(task_count);
+
+  auto start_time = std::chrono::high_resolution_clock::now();
+  pool.submit_n(task_count, [&](size_t i) { res[i] = add(i, i); }).get();
+  auto end_time = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count();
+}
+
+// throughput (seconds for task_count tasks) and wake-up latency (microseconds for one task
+// submitted to an idle pool) of an idle policy
+static std::pair<double, double> idle_policy_benchmark(const hstl::IdlePolicy &policy, int thread_count,
+                                                       int task_count) {
+  auto add = [](int a, int b) { return a + b; };
+
+  hstl::ThreadPoolOptions options;
+  options.idle = policy;
+  hstl::ThreadPool pool(thread_count, options);
+
+  std::vector<std::future<int>> res(task_count);
+  auto start_time = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < task_count; i++) {
+    res[i] = pool.submit(add, i, i);
+  }
+  for (int i = 0; i < task_count; i++) {
+    res[i].get();
+  }
+  auto end_time = std::chrono::high_resolution_clock::now();
+  double throughput = std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count();
+
+  int rounds = 1000;
+  double latency = 0;
+  for (int i = 0; i < rounds; i++) {
+    // give the workers time to go idle
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    auto start = std::chrono::high_resolution_clock::now();
+    pool.submit(add, i, i).get();
+    auto end = std::chrono::high_resolution_clock::now();
+    latency += std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(end - start).count();
+  }
+  return {throughput, latency / rounds};
+}
+
+// keeps one worker busy with low priority tasks of about 10us each until stop is set
+struct BackgroundTask {
+  hstl::ThreadPool *pool;
+  std::atomic<bool> *stop;
+
+  void operator()() const {
+    auto end = std::chrono::high_resolution_clock::now() + std::chrono::microseconds(10);
+    while (std::chrono::high_resolution_clock::now() < end) {
+    }
+    if (!stop->load(std::memory_order_relaxed)) {
+      pool->post(hstl::TaskNode::create(*this), hstl::Priority::low);
+    }
+  }
+};
+
+// p50 and p99 latency (microseconds) of probe tasks of the given priority while every worker
+// is saturated with low priority background work
+static std::pair<double, double> priority_latency_benchmark(hstl::Priority priority, int thread_count) {
+  hstl::ThreadPool pool(thread_count);
+  std::atomic<bool> stop(false);
+  for (int i = 0; i < thread_count * 4; i++) {
+    pool.post(hstl::TaskNode::create(BackgroundTask{&pool, &stop}), hstl::Priority::low);
+  }
+
+  int rounds = 1000;
+  std::vector<double> latencies;
+  latencies.reserve(rounds);
+  for (int i = 0; i < rounds; i++) {
+    auto start = std::chrono::high_resolution_clock::now();
+    pool.submit(priority, []() {}).get();
+    auto end = std::chrono::high_resolution_clock::now();
+    latencies.push_back(std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(end - start).count());
+  }
+  stop.store(true);
+
+  std::sort(latencies.begin(), latencies.end());
+  return {latencies[rounds / 2], latencies[rounds * 99 / 100]};
+}
+
+// seconds for phases of small batch jobs, flushing one pool with wait_idle() between the
+// phases or creating a new pool for every phase
+static double phase_benchmark(int thread_count, int phase_count, int task_count, bool reuse) {
+  auto task = []() {};
+
+  auto start_time = std::chrono::high_resolution_clock::now();
+  if (reuse) {
+    hstl::ThreadPool pool(thread_count);
+    for (int phase = 0; phase < phase_count; phase++) {
+      for (int i = 0; i < task_count; i++) {
+        pool.post(hstl::TaskNode::create(task));
+      }
+      pool.wait_idle();
+    }
+  } else {
+    for (int phase = 0; phase < phase_count; phase++) {
+      hstl::ThreadPool pool(thread_count);
+      for (int i = 0; i < task_count; i++) {
+        pool.post(hstl::TaskNode::create(task));
+      }
+      pool.shutdown();
+    }
+  }
+  auto end_time = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count();
+}
+
+// seconds for bursts of tasks which block for 1ms (like I/O) followed by quiet periods, with
+// [thread_count, max_threads) more workers allowed in elastic mode (max_threads 0: fixed size)
+static double burst_benchmark(int thread_count, int max_threads, int burst_count, int burst_size) {
+  hstl::ThreadPoolOptions options;
+  options.elastic.max_threads = max_threads;
+  options.elastic.stall_timeout = std::chrono::milliseconds(1);
+  options.elastic.idle_timeout = std::chrono::milliseconds(20);
+  auto task = []() { std::this_thread::sleep_for(std::chrono::milliseconds(1)); };
+
+  hstl::ThreadPool pool(thread_count, options);
+  double busy = 0;
+  for (int burst = 0; burst < burst_count; burst++) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < burst_size; i++) {
+      pool.post(hstl::TaskNode::create(task));
+    }
+    pool.wait_idle();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    busy += std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  return busy;
+}
+
+// seconds for task_count empty tasks with and without ThreadPoolOptions::collect_stats
+static double stats_benchmark(int thread_count, int task_count, bool collect) {
+  hstl::ThreadPoolOptions options;
+  options.collect_stats = collect;
+  hstl::ThreadPool pool(thread_count, options);
+  auto task = []() {};
+
+  auto start_time = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < task_count; i++) {
+    pool.post(hstl::TaskNode::create(task));
+  }
+  pool.wait_idle();
+  auto end_time = std::chrono::high_resolution_clock::now();
+  if (collect) {
+    auto total = pool.stats().total();
+    std::cout << "  queue wait p50(us): " << total.queue_wait.percentile(50) / 1000.0
+              << ", p99(us): " << total.queue_wait.percentile(99) / 1000.0
+              << ", steals: " << total.steals << "/" << total.steal_attempts
+              << ", parks: " << total.parks << std::endl;
+  }
+  return std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count();
+}
+
+// ns per submit_after + cancel of timer_count timers, and the p50/p99 lateness (us) of
+// timer_count / 10 timers which are left to fire
+static std::tuple<double, double, double> timer_benchmark(int thread_count, int timer_count) {
+  hstl::ThreadPool pool(thread_count);
+  std::vector<hstl::TimerHandle> handles;
+  handles.reserve(timer_count);
+
+  auto start_time = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < timer_count; i++) {
+    handles.push_back(pool.submit_after(std::chrono::milliseconds(1 + i % 1000), []() {}));
+  }
+  for (auto &h : handles) {
+    h.cancel();
+  }
+  auto end_time = std::chrono::high_resolution_clock::now();
+  double cost = std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(end_time - start_time).count() /
+                timer_count;
+
+  int fire_count = timer_count / 10;
+  std::vector<double> lateness(fire_count);
+  std::atomic<int> fired(0);
+  for (int i = 0; i < fire_count; i++) {
+    auto due = std::chrono::steady_clock::now() + std::chrono::microseconds(100 * (i % 1000));
+    pool.submit_at(due, [&lateness, &fired, due, i]() {
+      lateness[i] = std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(
+          std::chrono::steady_clock::now() - due).count();
+      fired++;
+    });
+  }
+  while (fired.load() < fire_count) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::sort(lateness.begin(), lateness.end());
+  return {cost, lateness[fire_count / 2], lateness[fire_count * 99 / 100]};
+}
+
+// seconds for task_count posted tasks of which every fail_every-th throws (0: none), the errors
+// are dropped (the default) or kept in an error ring which is drained at the end
+static double failure_storm_benchmark(int thread_count, int task_count, int fail_every, bool ring) {
+  hstl::ThreadPoolOptions options;
+  options.error_ring_capacity = ring ? 4096 : 0;
+  hstl::ThreadPool pool(thread_count, options);
+  std::atomic<int> healthy(0);
+  auto start_time = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < task_count; i++) {
+    pool.post(hstl::TaskNode::create([&healthy, i, fail_every]() {
+      if (fail_every > 0 && i % fail_every == 0) {
+        throw std::runtime_error("failure storm");
+      }
+      healthy.fetch_add(1, std::memory_order_relaxed);
+    }));
+  }
+  pool.wait_idle();
+  pool.drain_errors();
+  auto end_time = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count();
+}
+
+// Speculative search: chunk_count tasks scan chunks of a range for a key which is in the first
+// chunk. Seconds until the task_group is done, with the finder cancelling the group or not.
+static double speculative_search_benchmark(int thread_count, int chunk_count, bool cancel) {
+  const int chunk = 10000;
+  hstl::ThreadPool pool(thread_count);
+  std::atomic<int> found(-1);
+  auto start_time = std::chrono::high_resolution_clock::now();
+  hstl::task_group group(pool);
+  for (int c = 0; c < chunk_count; c++) {
+    group.run([&found, &group, c, cancel](hstl::cancellation_token token) {
+      for (int i = c * chunk; i < (c + 1) * chunk && !token.is_cancelled(); i++) {
+        // some hashing per item
+        unsigned h = static_cast<unsigned>(i);
+        for (int k = 0; k < 16; k++) {
+          h = h * 2654435761u + 1;
+        }
+        if (i == chunk / 2 && h != 0) {
+          found = i;
+          if (cancel) {
+            group.cancel();
+          }
+        }
+      }
+    });
+  }
+  group.wait();
+  auto end_time = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count();
+}
+
+// recursive quicksort whose levels wait for their right half with ThreadPool::get
+static void nested_quicksort(hstl::ThreadPool &pool, int *first, int *last) {
+  if (last - first < 4096) {
+    std::sort(first, last);
+    return;
+  }
+  int pivot = first[(last - first) / 2];
+  int *mid1 = std::partition(first, last, [pivot](int v) { return v < pivot; });
+  int *mid2 = std::partition(mid1, last, [pivot](int v) { return v == pivot; });
+  auto right = pool.submit([&pool, mid2, last]() { nested_quicksort(pool, mid2, last); });
+  nested_quicksort(pool, first, mid1);
+  pool.get(right);
+}
+
+// seconds to sort n ints with nested_quicksort on the pool (thread_count > 0) or std::sort
+static double nested_sort_benchmark(int thread_count, int n) {
+  std::vector<int> values(n);
+  unsigned x = 1;
+  for (auto &v : values) {
+    x = x * 1103515245u + 12345u;
+    v = static_cast<int>(x >> 1);
+  }
+  auto start_time = std::chrono::high_resolution_clock::now();
+  if (thread_count > 0) {
+    hstl::ThreadPool pool(thread_count);
+    pool.submit([&pool, &values]() { nested_quicksort(pool, values.data(), values.data() + values.size()); }).get();
+  } else {
+    std::sort(values.begin(), values.end());
+  }
+  auto end_time = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count();
+}
+
+// A producer outrunning the workers: task_count tasks of about 1us each. Returns the seconds
+// and the most tasks waiting at once, unbounded (capacity 0) or with the given capacity and
+// overflow policy.
+static std::pair<double, size_t> backpressure_benchmark(int thread_count, int task_count, size_t capacity,
+                                                        hstl::OverflowPolicy overflow) {
+  hstl::ThreadPoolOptions options;
+  options.capacity = capacity;
+  options.overflow = overflow;
+  hstl::ThreadPool pool(thread_count, options);
+  size_t peak = 0;
+  auto start_time = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < task_count; i++) {
+    pool.submit([]() {
+      auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(1);
+      while (std::chrono::steady_clock::now() < until) {
+      }
+    });
+    if (i % 1024 == 0) {
+      peak = std::max(peak, pool.outstanding());
+    }
+  }
+  pool.wait_idle();
+  auto end_time = std::chrono::high_resolution_clock::now();
+  return {std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count(), peak};
+}
+
+#ifdef HSTL_COROUTINES
+// task_count computations hopping onto the pool, as coroutines (co_await schedule(), joined by
+// when_all) or as submit + future::get; seconds
+static double coroutine_benchmark(int thread_count, int task_count, bool coroutines) {
+  hstl::ThreadPool pool(thread_count);
+  auto start_time = std::chrono::high_resolution_clock::now();
+  if (coroutines) {
+    auto add = [](hstl::ThreadPool &pool, int a, int b) -> hstl::task<int> {
+      co_await pool.schedule();
+      co_return a + b;
+    };
+    std::vector<hstl::task<int>> tasks;
+    tasks.reserve(task_count);
+    for (int i = 0; i < task_count; i++) {
+      tasks.push_back(add(pool, i, i));
+    }
+    hstl::sync_wait(hstl::when_all(std::move(tasks)));
+  } else {
+    auto add = [](int a, int b) { return a + b; };
+    std::vector<std::future<int>> res;
+    res.reserve(task_count);
+    for (int i = 0; i < task_count; i++) {
+      res.push_back(pool.submit(add, i, i));
+    }
+    for (auto &f : res) {
+      f.get();
+    }
+  }
+  auto end_time = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count();
+}
+#endif
+
+// heap allocations per submit + get once the pool is warmed up
+static double allocation_benchmark(int thread_count, int task_count) {
+  auto add = [](int a, int b) { return a + b; };
+
+  hstl::ThreadPool pool(thread_count);
+
+  std::vector<std::future<int>> res(task_count);
+  auto round = [&]() {
+    for (int i = 0; i < task_count; i++) {
+      res[i] = pool.submit(add, i, i);
+    }
+    for (int i = 0; i < task_count; i++) {
+      res[i].get();
+    }
+  };
+
+  // warm up the task pool, the inboxes and the deques until they reach the peak working set
+  for (int i = 0; i < 5; i++) {
+    round();
+  }
+  size_t before = allocation_count.load();
+  round();
+  size_t after = allocation_count.load();
+  return static_cast<double>(after - before) / task_count;
+}
+
 int main() {
   std::vector<int> thread_counts = {1, 2, 3, 4, 8, 16, 32, 64, 128};
   int task_count = 1000000;
 
   int repeat_times = 10;
 
-  for (int i = 0; i < thread_counts.size(); i++) {
+  for (size_t i = 0; i < thread_counts.size(); i++) {
     double average = 0;
     for (int j = 0; j < repeat_times; j++) {
       average += lock_contention_benchmark(thread_counts[i], task_count);
@@ -39,4 +460,118 @@ int main() {
     average /= repeat_times;
     std::cout << "thread_count: " << thread_counts[i] << ", task_count: " << task_count << ", average cost time: " << average << std::endl;
   }
-}
\ No newline at end of file
+
+  for (size_t i = 0; i < thread_counts.size(); i++) {
+    double average = 0;
+    for (int j = 0; j < repeat_times; j++) {
+      average += batch_benchmark(thread_counts[i], task_count);
+    }
+    average /= repeat_times;
+    std::cout << "thread_count: " << thread_counts[i] << ", task_count: " << task_count
+              << ", submit_n average cost time: " << average << std::endl;
+  }
+
+  std::vector<std::pair<const char*, hstl::IdlePolicy>> policies = {
+    {"park", hstl::IdlePolicy::park()},
+    {"spin_then_park", hstl::IdlePolicy::spin_then_park()},
+    {"busy_spin", hstl::IdlePolicy::busy_spin()},
+  };
+  for (auto &[name, policy] : policies) {
+    for (int thread_count : {2, 4, 8}) {
+      auto [throughput, latency] = idle_policy_benchmark(policy, thread_count, task_count);
+      std::cout << "idle policy: " << name << ", thread_count: " << thread_count << ", task_count: " << task_count
+                << ", cost time: " << throughput << ", wake-up latency(us): " << latency << std::endl;
+    }
+  }
+
+  for (int thread_count : {2, 4, 8}) {
+    auto [p50, p99] = priority_latency_benchmark(hstl::Priority::high, thread_count);
+    std::cout << "high priority under low priority saturation, thread_count: " << thread_count
+              << ", latency p50(us): " << p50 << ", p99(us): " << p99 << std::endl;
+  }
+
+  for (int thread_count : {2, 4, 8}) {
+    std::cout << "thread_count: " << thread_count << ", phases: 1000 x 100 tasks"
+              << ", wait_idle: " << phase_benchmark(thread_count, 1000, 100, true)
+              << ", new pool per phase: " << phase_benchmark(thread_count, 1000, 100, false) << std::endl;
+  }
+
+  std::cout << "bursts: 10 x 256 blocking tasks, fixed 2 threads: " << burst_benchmark(2, 0, 10, 256)
+            << ", fixed 32 threads: " << burst_benchmark(32, 0, 10, 256)
+            << ", elastic 2-32 threads: " << burst_benchmark(2, 32, 10, 256) << std::endl;
+
+  for (int thread_count : {2, 4, 8}) {
+    double off = stats_benchmark(thread_count, task_count, false);
+    double on = stats_benchmark(thread_count, task_count, true);
+    std::cout << "thread_count: " << thread_count << ", task_count: " << task_count
+              << ", stats off: " << off << ", stats on: " << on << std::endl;
+  }
+
+  for (int thread_count : {2, 4, 8}) {
+    auto [cost, p50, p99] = timer_benchmark(thread_count, 1000000);
+    std::cout << "thread_count: " << thread_count << ", timers: 1000000, submit_after + cancel(ns): " << cost
+              << ", lateness p50(us): " << p50 << ", p99(us): " << p99 << std::endl;
+  }
+
+  for (int thread_count : {2, 4, 8}) {
+    std::cout << "thread_count: " << thread_count << ", task_count: " << task_count
+              << ", no failures: " << failure_storm_benchmark(thread_count, task_count, 0, false)
+              << ", 1 in 2 failing: " << failure_storm_benchmark(thread_count, task_count, 2, false)
+              << ", 1 in 2 failing with error ring: " << failure_storm_benchmark(thread_count, task_count, 2, true)
+              << std::endl;
+  }
+
+  for (int thread_count : {2, 4, 8}) {
+    std::cout << "thread_count: " << thread_count << ", speculative search over 1000 chunks"
+              << ", run to completion: " << speculative_search_benchmark(thread_count, 1000, false)
+              << ", cancel on first hit: " << speculative_search_benchmark(thread_count, 1000, true)
+              << std::endl;
+  }
+
+  std::vector<std::pair<const char*, hstl::OverflowPolicy>> overflows = {
+    {"block", hstl::OverflowPolicy::block},
+    {"caller_runs", hstl::OverflowPolicy::caller_runs},
+    {"drop_oldest", hstl::OverflowPolicy::drop_oldest},
+  };
+  for (int thread_count : {2, 4}) {
+    auto [unbounded, unbounded_peak] = backpressure_benchmark(thread_count, task_count, 0, hstl::OverflowPolicy::block);
+    std::cout << "thread_count: " << thread_count << ", task_count: " << task_count
+              << ", unbounded: " << unbounded << "s, peak queue " << unbounded_peak;
+    for (auto &[name, overflow] : overflows) {
+      auto [cost, peak] = backpressure_benchmark(thread_count, task_count, 4096, overflow);
+      std::cout << ", capacity 4096 " << name << ": " << cost << "s, peak queue " << peak;
+    }
+    std::cout << std::endl;
+  }
+
+  std::cout << "nested quicksort of 10M ints, std::sort: " << nested_sort_benchmark(0, 10000000);
+  for (int thread_count : {1, 2, 4, 8}) {
+    std::cout << ", " << thread_count << " threads: " << nested_sort_benchmark(thread_count, 10000000);
+  }
+  std::cout << std::endl;
+
+#ifdef HSTL_COROUTINES
+  for (int thread_count : {2, 4, 8}) {
+    std::cout << "thread_count: " << thread_count << ", task_count: " << task_count
+              << ", coroutines: " << coroutine_benchmark(thread_count, task_count, true)
+              << ", futures: " << coroutine_benchmark(thread_count, task_count, false) << std::endl;
+  }
+#endif
+
+  std::vector<int> producer_counts = {1, 2, 4, 8};
+  int pool_thread_count = 4;
+  for (size_t i = 0; i < producer_counts.size(); i++) {
+    double average = 0;
+    for (int j = 0; j < repeat_times; j++) {
+      average += multi_producer_benchmark(pool_thread_count, producer_counts[i], task_count);
+    }
+    average /= repeat_times;
+    std::cout << "thread_count: " << pool_thread_count << ", producer_count: " << producer_counts[i]
+              << ", task_count: " << task_count << ", average cost time: " << average << std::endl;
+  }
+
+  for (size_t i = 0; i < thread_counts.size(); i++) {
+    std::cout << "thread_count: " << thread_counts[i] << ", task_count: " << task_count
+              << ", allocations per task: " << allocation_benchmark(thread_counts[i], task_count) << std::endl;
+  }
+}
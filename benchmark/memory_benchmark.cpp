@@ -0,0 +1,96 @@
+#include "memory.hpp"
+#include "vector.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+struct Pod {
+  int a;
+  int b;
+  int c;
+};
+
+// best of repeat runs of f, in seconds
+static double time_best(const std::function<void()> &f, int repeat = 5) {
+  double best = 1e9;
+  for (int r = 0; r < repeat; r++) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    f();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    best = std::min(best, std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count());
+  }
+  return best;
+}
+
+// uninitialized_copy/fill_n of count elements: the element-wise path against the memmove
+// (memset) path and plain memcpy (memset)
+template <typename T>
+static void primitives_benchmark(const char *name, size_t count, const T &value) {
+  std::allocator<T> alloc;
+  T *src = alloc.allocate(count);
+  T *dst = alloc.allocate(count);
+  std::memset(static_cast<void *>(src), 1, count * sizeof(T));
+  // touch the pages once so that every run measures the copy only
+  std::memset(static_cast<void *>(dst), 0, count * sizeof(T));
+
+  double copy_loop = time_best([&]() { hstl::memory_detail::uninitialized_copy(src, src + count, dst, hstl::false_type()); });
+  double copy_fast = time_best([&]() { hstl::uninitialized_copy(src, src + count, dst); });
+  double copy_memcpy = time_best([&]() { std::memcpy(static_cast<void *>(dst), src, count * sizeof(T)); });
+  double fill_loop = time_best([&]() { hstl::memory_detail::uninitialized_fill_n(dst, count, value, hstl::false_type()); });
+  double fill_fast = time_best([&]() { hstl::uninitialized_fill_n(dst, count, value); });
+
+  std::cout << name << " x " << count << ", copy element-wise: " << copy_loop << ", copy: " << copy_fast
+            << ", memcpy: " << copy_memcpy << ", fill element-wise: " << fill_loop << ", fill: " << fill_fast
+            << std::endl;
+  alloc.deallocate(src, count);
+  alloc.deallocate(dst, count);
+}
+
+// push_back count ints one by one, every reallocation moves the whole vector
+template <typename Vector>
+static double growth_benchmark(size_t count) {
+  return time_best([count]() {
+    Vector v;
+    for (size_t i = 0; i < count; i++) {
+      v.push_back(static_cast<int>(i));
+    }
+  });
+}
+
+// clear() of a vector of count elements; best of 5, the fill is not timed
+template <typename T>
+static double clear_benchmark(size_t count) {
+  double best = 1e9;
+  for (int r = 0; r < 5; r++) {
+    hstl::vector<T> v(count, T());
+    auto start_time = std::chrono::high_resolution_clock::now();
+    v.clear();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    best = std::min(best, std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count());
+  }
+  return best;
+}
+
+// an empty user-provided destructor is not trivial, clear() has to walk the elements
+struct PodWithDtor : Pod {
+  ~PodWithDtor() {}
+};
+
+int main() {
+  const size_t count = 16 * 1024 * 1024;
+  primitives_benchmark<int>("int (fill 0)", count, 0);
+  primitives_benchmark<int>("int (fill 7)", count, 7);
+  primitives_benchmark<Pod>("Pod (fill 0)", count / 3, Pod{0, 0, 0});
+
+  for (size_t n : {size_t(1) << 16, size_t(1) << 20, size_t(1) << 24}) {
+    std::cout << "push_back " << n << " ints, hstl::vector: " << growth_benchmark<hstl::vector<int>>(n)
+              << ", std::vector: " << growth_benchmark<std::vector<int>>(n) << std::endl;
+  }
+
+  std::cout << "clear " << count / 3 << " elements, Pod: " << clear_benchmark<Pod>(count / 3)
+            << ", Pod with a destructor: " << clear_benchmark<PodWithDtor>(count / 3) << std::endl;
+}
@@ -0,0 +1,67 @@
+#include "small_vector.hpp"
+#include "span.hpp"
+#include "vector.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+// Every operator new goes through here, so that we can count the heap allocations made by
+// each container
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+  ++allocations;
+  if (void *p = std::malloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+static long sum(hstl::span<const int> s) {
+  long result = 0;
+  for (int v : s) {
+    result += v;
+  }
+  return result;
+}
+
+// Builds list_count short lists of 1 to max_length ints one at a time (like per-request lists
+// living on the stack), prints seconds and mallocs per list
+template <typename Vector>
+static void short_lists_benchmark(const std::string &name, size_t list_count, size_t max_length) {
+  allocations = 0;
+  long checksum = 0;
+  auto start_time = std::chrono::high_resolution_clock::now();
+  for (size_t i = 0; i < list_count; i++) {
+    Vector v;
+    size_t length = 1 + i % max_length;
+    for (size_t j = 0; j < length; j++) {
+      v.push_back(static_cast<int>(j));
+    }
+    checksum += sum(v);
+  }
+  auto end_time = std::chrono::high_resolution_clock::now();
+  std::cout << "  " << name << ": "
+            << std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count() << "s, "
+            << static_cast<double>(allocations) / list_count << " mallocs per list (checksum " << checksum << ")"
+            << std::endl;
+}
+
+static void lengths_benchmark(size_t list_count, size_t max_length) {
+  std::cout << list_count << " lists of 1-" << max_length << " ints" << std::endl;
+  short_lists_benchmark<std::vector<int>>("std::vector", list_count, max_length);
+  short_lists_benchmark<hstl::vector<int>>("hstl::vector", list_count, max_length);
+  short_lists_benchmark<hstl::small_vector<int, 8>>("hstl::small_vector<int, 8>", list_count, max_length);
+}
+
+int main() {
+  lengths_benchmark(size_t(1) << 24, 8);
+  lengths_benchmark(size_t(1) << 24, 16);
+}
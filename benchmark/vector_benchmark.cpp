@@ -0,0 +1,105 @@
+#include "unique_ptr.hpp"
+#include "vector.hpp"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Runs f in a child process, so that every policy starts from a fresh heap and the peak RSS
+// (ru_maxrss) is its own.
+static void run_isolated(const std::function<void()> &f) {
+  std::cout.flush();
+  pid_t pid = fork();
+  if (pid == 0) {
+    f();
+    std::cout.flush();
+    _exit(0);
+  }
+  int status;
+  waitpid(pid, &status, 0);
+}
+
+static long peak_rss_mb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss / 1024;
+}
+
+// push_back count ints into each of vector_count vectors round-robin (so that their blocks
+// interleave in the heap); prints seconds, peak RSS and how much of the capacity is used
+template <typename Vector>
+static void growth_benchmark(const std::string &name, size_t vector_count, size_t count) {
+  run_isolated([&]() {
+    std::vector<Vector> vectors(vector_count);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < count; i++) {
+      for (auto &v : vectors) {
+        v.push_back(static_cast<int>(i));
+      }
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    size_t capacity = 0;
+    for (auto &v : vectors) {
+      capacity += v.capacity();
+    }
+    std::cout << "  " << name << ": "
+              << std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count()
+              << "s, peak RSS: " << peak_rss_mb() << "MB, used capacity: " << 100 * vector_count * count / capacity
+              << "%" << std::endl;
+  });
+}
+
+static void policies_benchmark(size_t vector_count, size_t count) {
+  std::cout << vector_count << " vectors x " << count << " ints (" << vector_count * count * sizeof(int) / (1 << 20)
+            << "MB)" << std::endl;
+  growth_benchmark<std::vector<int>>("std::vector", vector_count, count);
+  growth_benchmark<hstl::vector<int>>("doubling", vector_count, count);
+  growth_benchmark<hstl::vector<int, std::allocator<int>, hstl::one_and_half_growth>>("1.5x", vector_count, count);
+  growth_benchmark<hstl::vector<int, hstl::malloc_allocator<int>, hstl::one_and_half_growth>>(
+      "1.5x + malloc size classes", vector_count, count);
+  growth_benchmark<hstl::vector<int, hstl::malloc_allocator<int>, hstl::huge_page_growth<>>>(
+      "1.5x + malloc size classes + huge pages", vector_count, count);
+}
+
+// push_back count default-constructed elements (null pointers), so that the time is spent in
+// growing: relocating the elements and faulting in the new blocks
+template <typename Vector>
+static void relocation_benchmark(const std::string &name, size_t count) {
+  run_isolated([&]() {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    Vector v;
+    for (size_t i = 0; i < count; i++) {
+      v.emplace_back();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::cout << "  " << name << ": "
+              << std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count()
+              << "s, peak RSS: " << peak_rss_mb() << "MB" << std::endl;
+  });
+}
+
+int main() {
+  policies_benchmark(1, size_t(48) << 20);
+  policies_benchmark(64, size_t(1) << 20);
+  policies_benchmark(100000, 100);
+
+  const size_t pointers = size_t(1) << 27;
+  std::cout << pointers << " pointers (1GB)" << std::endl;
+  relocation_benchmark<std::vector<void *>>("std::vector", pointers);
+  relocation_benchmark<hstl::vector<void *>>("hstl::vector, memcpy", pointers);
+  relocation_benchmark<hstl::vector<void *, hstl::malloc_allocator<void *>>>("hstl::vector, realloc", pointers);
+
+  const size_t unique_ptrs = size_t(1) << 25;
+  std::cout << unique_ptrs << " unique_ptrs (256MB)" << std::endl;
+  relocation_benchmark<std::vector<std::unique_ptr<int>>>("std::vector<std::unique_ptr>", unique_ptrs);
+  relocation_benchmark<hstl::vector<hstl::unique_ptr<int>>>("hstl::vector<hstl::unique_ptr>, memcpy", unique_ptrs);
+  relocation_benchmark<hstl::vector<hstl::unique_ptr<int>, hstl::malloc_allocator<hstl::unique_ptr<int>>>>(
+      "hstl::vector<hstl::unique_ptr>, realloc", unique_ptrs);
+}
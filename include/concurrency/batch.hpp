@@ -0,0 +1,137 @@
+#ifndef BATCH_HPP_
+#define BATCH_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "concurrency/executor.hpp"
+#include "concurrency/future.hpp"
+#include "concurrency/small_object_pool.hpp"
+
+namespace hstl {
+
+// Completion state shared by all the tasks of one batch (ThreadPool::submit_n/submit_batch).
+// One atomic counter instead of a future per task: the task which finishes last completes
+// the batch future and frees the state, so the future is never ready while tasks of the
+// batch are still running (even if one of them failed). F is the function shared by the
+// tasks of submit_n.
+template <typename F>
+class BatchState {
+ public:
+  static BatchState* create(Executor* executor, size_t count, F&& f) {
+    BatchState* s = pool_allocator<BatchState>().allocate(1);
+    return ::new (static_cast<void*>(s)) BatchState(executor, count, std::move(f));
+  }
+
+  future<void> get_future() { return promise_.get_future(); }
+
+  F& func() { return func_; }
+
+  // called exactly once per task, e is the exception of the task if any. The first
+  // exception is kept and delivered when the last task finishes
+  void finish(std::exception_ptr e) {
+    if (e && !failed_.exchange(true, std::memory_order_acq_rel)) {
+      error_ = std::move(e);
+    }
+    if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      if (error_) {
+        promise_.set_exception(std::move(error_));
+      } else {
+        promise_.set_value();
+      }
+      this->~BatchState();
+      pool_allocator<BatchState>().deallocate(this, 1);
+    }
+  }
+
+ private:
+  BatchState(Executor* executor, size_t count, F&& f)
+      : remaining_(count), failed_(false), error_(), promise_(executor), func_(std::move(f)) {}
+
+  std::atomic<size_t> remaining_;
+  std::atomic<bool> failed_;
+  // written only by the task which set failed_, read by the last one
+  std::exception_ptr error_;
+  promise<void> promise_;
+  F func_;
+};
+
+// placeholder function of submit_batch, whose tasks carry their own callable
+struct batch_no_func {};
+
+// A task of a batch. Reports to the batch exactly once: when it has run, or with
+// broken_promise when it is destroyed without running (e.g. discarded by the pool).
+template <typename F, typename Callable = void>
+class BatchTask {
+ public:
+  using state_type = BatchState<F>;
+
+  // submit_n: runs state->func()(index)
+  BatchTask(state_type* state, size_t index) : state_(state), index_(index) {}
+
+  BatchTask(BatchTask&& other) noexcept
+      : state_(std::exchange(other.state_, nullptr)), index_(other.index_) {}
+  BatchTask(const BatchTask&) = delete;
+
+  ~BatchTask() {
+    if (state_ != nullptr) {
+      state_->finish(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+    }
+  }
+
+  void operator()() {
+    std::exception_ptr e;
+    try {
+      state_->func()(index_);
+    } catch (...) {
+      e = std::current_exception();
+    }
+    std::exchange(state_, nullptr)->finish(std::move(e));
+  }
+
+ private:
+  state_type* state_;
+  size_t index_;
+};
+
+// submit_batch: runs its own callable
+template <typename Callable>
+class BatchTask<batch_no_func, Callable> {
+ public:
+  using state_type = BatchState<batch_no_func>;
+
+  BatchTask(state_type* state, Callable&& c) : state_(state), callable_(std::move(c)) {}
+
+  BatchTask(BatchTask&& other) noexcept(std::is_nothrow_move_constructible_v<Callable>)
+      : state_(std::exchange(other.state_, nullptr)), callable_(std::move(other.callable_)) {}
+  BatchTask(const BatchTask&) = delete;
+
+  ~BatchTask() {
+    if (state_ != nullptr) {
+      state_->finish(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+    }
+  }
+
+  void operator()() {
+    std::exception_ptr e;
+    try {
+      callable_();
+    } catch (...) {
+      e = std::current_exception();
+    }
+    std::exchange(state_, nullptr)->finish(std::move(e));
+  }
+
+ private:
+  state_type* state_;
+  Callable callable_;
+};
+
+}  // namespace hstl
+
+#endif  // BATCH_HPP_
@@ -0,0 +1,322 @@
+#ifndef COROUTINE_HPP_
+#define COROUTINE_HPP_
+
+// C++20 only: lazy coroutine tasks on top of ThreadPool (co_await pool.schedule(), see
+// thread_pool.h). Including this header from a C++17 build defines nothing.
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "concurrency/small_object_pool.hpp"
+#include "concurrency/thread_pool.h"
+
+namespace hstl {
+
+template <typename T = void>
+class task;
+
+namespace coro_detail {
+
+// Coroutine frames come from SmallObjectPool like task nodes and future states: a frame freed
+// on the thread which allocated it never locks, and frames up to 1KB are recycled instead of
+// going through malloc every time.
+struct FrameAllocation {
+  static void* operator new(size_t size) { return SmallObjectPool::allocate(size); }
+  static void operator delete(void* p, size_t size) noexcept { SmallObjectPool::deallocate(p, size); }
+};
+
+class TaskPromiseBase : public FrameAllocation {
+ public:
+  // a task runs when it is awaited (lazy), and resumes its awaiter when it is done
+  std::suspend_always initial_suspend() noexcept { return {}; }
+
+  struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+      // symmetric transfer, a long chain of tasks does not grow the stack
+      return h.promise().continuation_;
+    }
+    void await_resume() const noexcept {}
+  };
+  FinalAwaiter final_suspend() noexcept { return {}; }
+
+  void unhandled_exception() noexcept { error_ = std::current_exception(); }
+
+  void set_continuation(std::coroutine_handle<> continuation) noexcept { continuation_ = continuation; }
+
+ protected:
+  void rethrow_if_failed() const {
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+ private:
+  std::coroutine_handle<> continuation_ = std::noop_coroutine();
+  std::exception_ptr error_;
+};
+
+template <typename T>
+class TaskPromise : public TaskPromiseBase {
+ public:
+  task<T> get_return_object() noexcept;
+
+  template <typename U = T, typename = std::enable_if_t<std::is_convertible_v<U&&, T>>>
+  void return_value(U&& value) {
+    value_.emplace(std::forward<U>(value));
+  }
+
+  T& result() & {
+    rethrow_if_failed();
+    return *value_;
+  }
+  T result() && {
+    rethrow_if_failed();
+    return std::move(*value_);
+  }
+
+ private:
+  std::optional<T> value_;
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase {
+ public:
+  task<void> get_return_object() noexcept;
+
+  void return_void() noexcept {}
+  void result() { rethrow_if_failed(); }
+};
+
+}  // namespace coro_detail
+
+// A lazily started coroutine producing a T: it runs when it is co_awaited (or by sync_wait),
+// on the thread which awaits it, until it suspends, e.g. in co_await pool.schedule(). The
+// awaiter is resumed where the task finishes. An exception escaping the coroutine is rethrown
+// to the awaiter. Move-only, destroying a task destroys its coroutine.
+template <typename T>
+class [[nodiscard]] task {
+ public:
+  using promise_type = coro_detail::TaskPromise<T>;
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  task() noexcept = default;
+  task(task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+  task& operator=(task&& other) noexcept {
+    if (this != &other) {
+      reset();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+  task(const task&) = delete;
+  task& operator=(const task&) = delete;
+  ~task() { reset(); }
+
+  bool valid() const noexcept { return handle_ != nullptr; }
+  bool is_ready() const noexcept { return handle_ == nullptr || handle_.done(); }
+
+  // co_await t gives a reference to the result, co_await std::move(t) moves it out
+  auto operator co_await() & noexcept { return Awaiter<false>{handle_}; }
+  auto operator co_await() && noexcept { return Awaiter<true>{handle_}; }
+
+  // waits for the task without taking its result or its exception
+  auto when_ready() noexcept { return Awaiter<false, true>{handle_}; }
+
+ private:
+  friend promise_type;
+
+  explicit task(handle_type handle) noexcept : handle_(handle) {}
+
+  template <bool Move, bool Discard = false>
+  struct Awaiter {
+    handle_type handle;
+
+    bool await_ready() const noexcept { return handle.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+      handle.promise().set_continuation(awaiter);
+      return handle;
+    }
+    decltype(auto) await_resume() {
+      if constexpr (Discard) {
+        return;
+      } else if constexpr (Move) {
+        return std::move(handle.promise()).result();
+      } else {
+        return handle.promise().result();
+      }
+    }
+  };
+
+  void reset() noexcept {
+    if (handle_) {
+      handle_.destroy();
+      handle_ = nullptr;
+    }
+  }
+
+  handle_type handle_ = nullptr;
+};
+
+namespace coro_detail {
+
+template <typename T>
+task<T> TaskPromise<T>::get_return_object() noexcept {
+  return task<T>(task<T>::handle_type::from_promise(*this));
+}
+
+inline task<void> TaskPromise<void>::get_return_object() noexcept {
+  return task<void>(task<void>::handle_type::from_promise(*this));
+}
+
+// A coroutine started by start(), which awaits a task and then calls done->finish() (and
+// resumes whatever that returns). Drives the tasks of sync_wait and when_all.
+template <typename Done>
+class Driver {
+ public:
+  struct promise_type : FrameAllocation {
+    Done* done = nullptr;
+
+    Driver get_return_object() noexcept {
+      return Driver(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    struct FinalAwaiter {
+      bool await_ready() const noexcept { return false; }
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+        // the frame is gone before anyone is told, Done must not touch it
+        Done* done = h.promise().done;
+        h.destroy();
+        return done->finish();
+      }
+      void await_resume() const noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    // the driven task keeps its exception, nothing escapes the driver
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+
+  void start(Done* done) {
+    handle_.promise().done = done;
+    std::exchange(handle_, nullptr).resume();
+  }
+
+  Driver(Driver&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+  ~Driver() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+ private:
+  explicit Driver(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+  std::coroutine_handle<promise_type> handle_;
+};
+
+template <typename Done, typename T>
+Driver<Done> drive(task<T>& t) {
+  co_await t.when_ready();
+}
+
+struct SyncWaitEvent {
+  std::mutex lock;
+  std::condition_variable cv;
+  bool done = false;
+
+  std::coroutine_handle<> finish() noexcept {
+    // notify under the lock, the waiter may destroy the event as soon as it is released
+    std::lock_guard<std::mutex> guard(lock);
+    done = true;
+    cv.notify_one();
+    return std::noop_coroutine();
+  }
+  void wait() {
+    std::unique_lock<std::mutex> guard(lock);
+    cv.wait(guard, [this]() { return done; });
+  }
+};
+
+// counts the tasks of when_all which are still running, plus one for when_all itself
+struct WhenAllCounter {
+  std::atomic<size_t> count;
+  std::coroutine_handle<> parent;
+
+  std::coroutine_handle<> finish() noexcept {
+    if (count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      return parent;
+    }
+    return std::noop_coroutine();
+  }
+};
+
+template <typename T>
+using when_all_result_t = std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
+
+}  // namespace coro_detail
+
+// Runs t to completion and blocks the calling thread until then, returns its result or
+// rethrows its exception. The bridge from blocking code to coroutines, e.g. in main(); must
+// not be called from a worker of a pool the task needs.
+template <typename T>
+T sync_wait(task<T> t) {
+  coro_detail::SyncWaitEvent event;
+  coro_detail::drive<coro_detail::SyncWaitEvent>(t).start(&event);
+  event.wait();
+  // t is done, take its result the way co_await does
+  return std::move(t).operator co_await().await_resume();
+}
+
+// Runs all the tasks concurrently: every task is started on the awaiting thread and runs until
+// it first suspends (e.g. in pool.schedule()), so n tasks in flight cost n coroutine frames and
+// no thread. Completes once all of them have, with their results in order; the first exception
+// (in order) is rethrown after all the tasks are done.
+template <typename T>
+task<coro_detail::when_all_result_t<T>> when_all(std::vector<task<T>> tasks) {
+  coro_detail::WhenAllCounter counter{tasks.size() + 1, nullptr};
+  struct StartAll {
+    std::vector<task<T>>& tasks;
+    coro_detail::WhenAllCounter& counter;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> parent) {
+      counter.parent = parent;
+      for (auto& t : tasks) {
+        coro_detail::drive<coro_detail::WhenAllCounter>(t).start(&counter);
+      }
+      // resume right away if all of them have finished already
+      return counter.count.fetch_sub(1, std::memory_order_acq_rel) != 1;
+    }
+    void await_resume() const noexcept {}
+  };
+  co_await StartAll{tasks, counter};
+
+  if constexpr (std::is_void_v<T>) {
+    for (auto& t : tasks) {
+      co_await std::move(t);
+    }
+  } else {
+    std::vector<T> results;
+    results.reserve(tasks.size());
+    for (auto& t : tasks) {
+      results.push_back(co_await std::move(t));
+    }
+    co_return results;
+  }
+}
+
+}  // namespace hstl
+
+#endif  // __cpp_impl_coroutine
+
+#endif  // COROUTINE_HPP_
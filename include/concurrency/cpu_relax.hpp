@@ -0,0 +1,18 @@
+#ifndef CPU_RELAX_HPP_
+#define CPU_RELAX_HPP_
+
+namespace hstl {
+
+// hint to the CPU that this is a spin-wait loop (x86 pause / arm yield), lets the sibling
+// hyper-thread run and avoids the memory order violation flush when the loop exits
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+}  // namespace hstl
+
+#endif  // CPU_RELAX_HPP_
@@ -0,0 +1,123 @@
+#ifndef CPU_TOPOLOGY_HPP_
+#define CPU_TOPOLOGY_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace hstl {
+
+// The CPUs the process may run on and the NUMA node of each, read from /sys on Linux.
+// Elsewhere (or when /sys is not readable) every CPU is on node 0.
+struct CpuTopology {
+  std::vector<int> cpus;   // sorted by node, then by CPU number
+  std::vector<int> nodes;  // nodes[i] is the node of cpus[i]
+
+  static CpuTopology detect() {
+    std::vector<int> allowed = allowed_cpus();
+    CpuTopology topology;
+    for (int node : parse_cpulist(read_line("/sys/devices/system/node/online"))) {
+      std::string path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+      for (int cpu : parse_cpulist(read_line(path))) {
+        if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) {
+          topology.cpus.push_back(cpu);
+          topology.nodes.push_back(node);
+        }
+      }
+    }
+    if (topology.cpus.empty()) {
+      topology.cpus = allowed;
+      topology.nodes.assign(allowed.size(), 0);
+    }
+    return topology;
+  }
+
+  // node of cpu, 0 if unknown
+  int node_of(int cpu) const {
+    auto it = std::find(cpus.begin(), cpus.end(), cpu);
+    return it == cpus.end() ? 0 : nodes[it - cpus.begin()];
+  }
+
+  // "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}, the format of the cpulist files in /sys
+  static std::vector<int> parse_cpulist(const std::string& list) {
+    std::vector<int> cpus;
+    size_t pos = 0;
+    while (pos < list.size()) {
+      size_t end = list.find(',', pos);
+      if (end == std::string::npos) {
+        end = list.size();
+      }
+      std::string item = list.substr(pos, end - pos);
+      size_t dash = item.find('-');
+      try {
+        int first = std::stoi(item.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+        for (int cpu = first; cpu <= last; cpu++) {
+          cpus.push_back(cpu);
+        }
+      } catch (const std::exception&) {
+        // empty or malformed item
+      }
+      pos = end + 1;
+    }
+    return cpus;
+  }
+
+  // the CPUs of the affinity mask of the process
+  static std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+      for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set)) {
+          cpus.push_back(cpu);
+        }
+      }
+    }
+#endif
+    if (cpus.empty()) {
+      for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++) {
+        cpus.push_back(static_cast<int>(cpu));
+      }
+    }
+    return cpus;
+  }
+
+  static std::string read_line(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+  }
+
+  // pins the calling thread to cpu, false if that is not possible
+  static bool pin_current_thread(int cpu) {
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+      return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+  }
+};
+
+}  // namespace hstl
+
+#endif  // CPU_TOPOLOGY_HPP_
@@ -0,0 +1,49 @@
+#ifndef ERROR_RING_HPP_
+#define ERROR_RING_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+#include "concurrency/mpmc_queue.hpp"
+
+namespace hstl {
+
+// Bounded lock-free queue of exceptions, an MpmcQueue: any number of threads push, any number
+// drain. When the ring is full a push gives up instead of waiting, the error is dropped and
+// counted.
+class ErrorRing {
+ public:
+  // the capacity is rounded up to a power of two
+  explicit ErrorRing(size_t capacity) : queue_(capacity), dropped_(0) {}
+
+  ErrorRing(const ErrorRing&) = delete;
+  ErrorRing& operator=(const ErrorRing&) = delete;
+
+  size_t capacity() const { return queue_.capacity(); }
+
+  // false if the ring is full and error was dropped
+  bool push(std::exception_ptr error) noexcept {
+    if (queue_.try_push(std::move(error))) {
+      return true;
+    }
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // false if the ring is empty
+  bool pop(std::exception_ptr& error) noexcept { return queue_.try_pop(error); }
+
+  // errors which did not fit so far
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  MpmcQueue<std::exception_ptr> queue_;
+  alignas(64) std::atomic<uint64_t> dropped_;
+};
+
+}  // namespace hstl
+
+#endif  // ERROR_RING_HPP_
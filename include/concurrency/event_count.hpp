@@ -0,0 +1,130 @@
+#ifndef EVENT_COUNT_HPP_
+#define EVENT_COUNT_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace hstl {
+
+// Lets threads block until a lock-free condition may have changed, without a lock on the
+// fast path (an event count, as in folly and Vyukov's designs):
+//
+//   waiter:                              notifier:
+//     while (!ready()) {                   make ready() true
+//       auto key = ec.prepare_wait();      ec.notify_one();
+//       if (ready()) {
+//         ec.cancel_wait();
+//         break;
+//       }
+//       ec.wait(key);
+//     }
+//
+// prepare_wait and notify form a Dekker pair: either the waiter sees the change in its second
+// check, or the notifier sees the waiter and bumps the epoch it sleeps on. Like the condition
+// variable of glibc, the notifiers count the waiters they have signalled: while all of them
+// are signalled but have not run yet (one core, a burst of pushes) a notify skips the system
+// call. A notify with no waiter costs a fence and a load. Blocks in a futex on Linux, a
+// condition variable elsewhere.
+class EventCount {
+ public:
+  EventCount() : epoch_(0), state_(0) {}
+
+  EventCount(const EventCount&) = delete;
+  EventCount& operator=(const EventCount&) = delete;
+
+  uint32_t prepare_wait() {
+    state_.fetch_add(kWaiter, std::memory_order_seq_cst);
+    return epoch_.load(std::memory_order_seq_cst);
+  }
+
+  // a signal which counted this waiter was not needed, it is dropped with it
+  void cancel_wait() {
+    leave([](uint64_t waiters, uint64_t signals) { return std::min(signals, waiters - 1); });
+  }
+
+  // returns once a notify happened after prepare_wait() returned key (or spuriously)
+  void wait(uint32_t key) {
+#if defined(__linux__)
+    while (epoch_.load(std::memory_order_acquire) == key) {
+      syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE, key, nullptr, nullptr, 0);
+    }
+#else
+    std::unique_lock<std::mutex> guard(lock_);
+    cv_.wait(guard, [this, key]() { return epoch_.load(std::memory_order_acquire) != key; });
+#endif
+    // takes one signal, whichever notify woke it
+    leave([](uint64_t, uint64_t signals) { return signals > 0 ? signals - 1 : 0; });
+  }
+
+  void notify_one() { notify(false); }
+  void notify_all() { notify(true); }
+
+ private:
+  // state_: waiters in the low half, signalled waiters in the high half, signals <= waiters
+  static constexpr uint64_t kWaiter = 1;
+  static constexpr uint64_t kSignal = uint64_t(1) << 32;
+
+  template <typename Signals>
+  void leave(Signals&& signals_left) {
+    uint64_t state = state_.load(std::memory_order_relaxed);
+    for (;;) {
+      uint64_t waiters = state & (kSignal - 1);
+      uint64_t signals = signals_left(waiters, state >> 32);
+      if (state_.compare_exchange_weak(state, (signals << 32) | (waiters - 1), std::memory_order_relaxed)) {
+        return;
+      }
+    }
+  }
+
+  void notify(bool all) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t state = state_.load(std::memory_order_seq_cst);
+    for (;;) {
+      uint64_t waiters = state & (kSignal - 1);
+      uint64_t signals = state >> 32;
+      if (waiters <= signals) {
+        return;
+      }
+      uint64_t next = all ? (waiters << 32) | waiters : state + kSignal;
+      if (state_.compare_exchange_weak(state, next, std::memory_order_seq_cst)) {
+        break;
+      }
+    }
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE, all ? INT_MAX : 1, nullptr,
+            nullptr, 0);
+#else
+    { std::lock_guard<std::mutex> guard(lock_); }
+    if (all) {
+      cv_.notify_all();
+    } else {
+      cv_.notify_one();
+    }
+#endif
+  }
+
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "the futex word is the atomic itself");
+
+  std::atomic<uint32_t> epoch_;
+  std::atomic<uint64_t> state_;
+#if !defined(__linux__)
+  std::mutex lock_;
+  std::condition_variable cv_;
+#endif
+};
+
+}  // namespace hstl
+
+#endif  // EVENT_COUNT_HPP_
@@ -0,0 +1,21 @@
+#ifndef EXECUTOR_HPP_
+#define EXECUTOR_HPP_
+
+#include "concurrency/task_node.hpp"
+
+namespace hstl {
+
+// Something tasks can be posted to, e.g. ThreadPool.
+// Lets futures schedule continuations without depending on the pool itself.
+class Executor {
+ public:
+  // takes the ownership of task, which is eventually run() or discard()ed
+  virtual void post(TaskNode* task) = 0;
+
+ protected:
+  ~Executor() = default;
+};
+
+}  // namespace hstl
+
+#endif  // EXECUTOR_HPP_
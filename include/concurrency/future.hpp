@@ -0,0 +1,497 @@
+#ifndef FUTURE_HPP_
+#define FUTURE_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "concurrency/executor.hpp"
+#include "concurrency/small_object_pool.hpp"
+#include "concurrency/task_node.hpp"
+
+namespace hstl {
+
+template <typename T>
+class future;
+template <typename T>
+class promise;
+
+// the value slot of future<void>
+struct future_unit {};
+
+// Shared state of a promise/future pair, allocated from SmallObjectPool.
+//
+// Synchronization goes through one atomic word:
+//   kEmpty                  not ready, nobody is waiting
+//   kReady                  the value or the exception has been published
+//   TaskNode* [| kInline]   not ready, a continuation runs once it is
+// A continuation either runs inline on the thread that completes the state (kInline, used by
+// waiters and when_all/when_any) or is posted to the executor the state was created with.
+template <typename T>
+class FutureState {
+ public:
+  using value_type = std::conditional_t<std::is_void_v<T>, future_unit, T>;
+
+  static FutureState* create(Executor* executor) {
+    FutureState* s = pool_allocator<FutureState>().allocate(1);
+    return ::new (static_cast<void*>(s)) FutureState(executor);
+  }
+
+  void add_ref() { refs_.fetch_add(1, std::memory_order_relaxed); }
+
+  void release() {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      this->~FutureState();
+      pool_allocator<FutureState>().deallocate(this, 1);
+    }
+  }
+
+  bool is_ready() const { return state_.load(std::memory_order_acquire) == kReady; }
+
+  template <typename... Args>
+  void set_value(Args&&... args) {
+    ::new (static_cast<void*>(storage_)) value_type(std::forward<Args>(args)...);
+    has_value_ = true;
+    complete();
+  }
+
+  void set_exception(std::exception_ptr e) {
+    error_ = std::move(e);
+    complete();
+  }
+
+  // node runs once the state is ready, right now if it already is
+  void subscribe(TaskNode* node, bool inline_run) {
+    uintptr_t word = reinterpret_cast<uintptr_t>(node) | (inline_run ? kInline : 0);
+    uintptr_t expected = kEmpty;
+    if (state_.compare_exchange_strong(expected, word, std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+      return;
+    }
+    dispatch(word);
+  }
+
+  // only valid once ready
+  const std::exception_ptr& error() const { return error_; }
+  value_type& value() { return *std::launder(reinterpret_cast<value_type*>(storage_)); }
+
+  Executor* executor() const { return executor_; }
+
+ private:
+  static constexpr uintptr_t kEmpty = 0;
+  static constexpr uintptr_t kReady = 1;
+  static constexpr uintptr_t kInline = 2;
+
+  explicit FutureState(Executor* executor)
+      : state_(kEmpty), refs_(1), executor_(executor), has_value_(false) {}
+
+  ~FutureState() {
+    if (has_value_) {
+      value().~value_type();
+    }
+  }
+
+  void complete() {
+    uintptr_t old = state_.exchange(kReady, std::memory_order_acq_rel);
+    if (old != kEmpty) {
+      dispatch(old);
+    }
+  }
+
+  void dispatch(uintptr_t word) {
+    TaskNode* node = reinterpret_cast<TaskNode*>(word & ~(kReady | kInline));
+    if ((word & kInline) || executor_ == nullptr) {
+      node->run();
+    } else {
+      executor_->post(node);
+    }
+  }
+
+  std::atomic<uintptr_t> state_;
+  std::atomic<int> refs_;
+  Executor* executor_;
+  bool has_value_;
+  std::exception_ptr error_;
+  alignas(value_type) unsigned char storage_[sizeof(value_type)];
+};
+
+template <typename F, typename T>
+struct then_result {
+  using type = std::invoke_result_t<F, T>;
+};
+
+template <typename F>
+struct then_result<F, void> {
+  using type = std::invoke_result_t<F>;
+};
+
+template <typename F, typename T>
+using then_result_t = typename then_result<F, T>::type;
+
+// A single-consumer future without mutex or condition variable in its shared state.
+// Unlike std::future it supports continuations: then() runs the continuation on the
+// executor (pool) which produced the future, instead of parking a thread in get().
+template <typename T>
+class future {
+ public:
+  future() noexcept : state_(nullptr) {}
+  future(future&& other) noexcept : state_(std::exchange(other.state_, nullptr)) {}
+  future& operator=(future&& other) noexcept {
+    if (this != &other) {
+      reset();
+      state_ = std::exchange(other.state_, nullptr);
+    }
+    return *this;
+  }
+  future(const future&) = delete;
+  future& operator=(const future&) = delete;
+  ~future() { reset(); }
+
+  bool valid() const noexcept { return state_ != nullptr; }
+  bool is_ready() const {
+    check_state();
+    return state_->is_ready();
+  }
+
+  void wait() const;
+  T get();
+
+  // f(T) runs on the executor of this future once it is ready, an exception skips f and
+  // goes straight to the returned future. Consumes *this.
+  template <typename F>
+  auto then(F&& f) -> future<then_result_t<F, T>>;
+
+  // f(future<T>) runs inline on the thread which completes this future, or right here if it
+  // is already ready. f must be cheap and must not throw. Consumes *this.
+  template <typename F>
+  void subscribe(F&& f);
+
+ private:
+  template <typename U>
+  friend class future;
+  friend class promise<T>;
+
+  explicit future(FutureState<T>* state) noexcept : state_(state) {}
+
+  void check_state() const {
+    if (state_ == nullptr) {
+      throw std::future_error(std::future_errc::no_state);
+    }
+  }
+
+  void reset() {
+    if (state_ != nullptr) {
+      state_->release();
+      state_ = nullptr;
+    }
+  }
+
+  FutureState<T>* state_;
+};
+
+template <typename T>
+class promise {
+ public:
+  promise() : promise(nullptr) {}
+  // continuations of the future are posted to executor
+  explicit promise(Executor* executor)
+      : state_(FutureState<T>::create(executor)), retrieved_(false), satisfied_(false) {}
+
+  promise(promise&& other) noexcept
+      : state_(std::exchange(other.state_, nullptr)),
+        retrieved_(other.retrieved_),
+        satisfied_(other.satisfied_) {}
+  promise& operator=(promise&& other) noexcept {
+    if (this != &other) {
+      promise(std::move(other)).swap(*this);
+    }
+    return *this;
+  }
+  promise(const promise&) = delete;
+  promise& operator=(const promise&) = delete;
+
+  ~promise() {
+    if (state_ == nullptr) {
+      return;
+    }
+    if (!satisfied_) {
+      state_->set_exception(
+          std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+    }
+    state_->release();
+  }
+
+  void swap(promise& other) noexcept {
+    std::swap(state_, other.state_);
+    std::swap(retrieved_, other.retrieved_);
+    std::swap(satisfied_, other.satisfied_);
+  }
+
+  future<T> get_future() {
+    check_state();
+    if (retrieved_) {
+      throw std::future_error(std::future_errc::future_already_retrieved);
+    }
+    retrieved_ = true;
+    state_->add_ref();
+    return future<T>(state_);
+  }
+
+  template <typename... Args>
+  void set_value(Args&&... args) {
+    check_satisfied();
+    satisfied_ = true;
+    state_->set_value(std::forward<Args>(args)...);
+  }
+
+  void set_exception(std::exception_ptr e) {
+    check_satisfied();
+    satisfied_ = true;
+    state_->set_exception(std::move(e));
+  }
+
+  // set the result of f(args...), or the exception it throws
+  template <typename F, typename... Args>
+  void set_from(F&& f, Args&&... args) {
+    try {
+      if constexpr (std::is_void_v<T>) {
+        std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+        set_value();
+      } else {
+        set_value(std::invoke(std::forward<F>(f), std::forward<Args>(args)...));
+      }
+    } catch (...) {
+      set_exception(std::current_exception());
+    }
+  }
+
+ private:
+  void check_state() const {
+    if (state_ == nullptr) {
+      throw std::future_error(std::future_errc::no_state);
+    }
+  }
+
+  void check_satisfied() const {
+    check_state();
+    if (satisfied_) {
+      throw std::future_error(std::future_errc::promise_already_satisfied);
+    }
+  }
+
+  FutureState<T>* state_;
+  bool retrieved_;
+  bool satisfied_;
+};
+
+template <typename T>
+void future<T>::wait() const {
+  check_state();
+  if (state_->is_ready()) {
+    return;
+  }
+  // only a thread that actually blocks pays for a mutex and a condition variable,
+  // they live on its stack
+  std::mutex lock;
+  std::condition_variable cv;
+  bool done = false;
+  state_->subscribe(TaskNode::create([&lock, &cv, &done]() {
+                      std::lock_guard<std::mutex> guard(lock);
+                      done = true;
+                      cv.notify_one();
+                    }),
+                    true);
+  std::unique_lock<std::mutex> guard(lock);
+  cv.wait(guard, [&done]() { return done; });
+}
+
+template <typename T>
+T future<T>::get() {
+  wait();
+  future self(std::move(*this));
+  if (self.state_->error()) {
+    std::rethrow_exception(self.state_->error());
+  }
+  if constexpr (!std::is_void_v<T>) {
+    return std::move(self.state_->value());
+  }
+}
+
+template <typename T>
+template <typename F>
+auto future<T>::then(F&& f) -> future<then_result_t<F, T>> {
+  using R = then_result_t<F, T>;
+  check_state();
+  FutureState<T>* state = state_;
+  promise<R> p(state->executor());
+  future<R> next = p.get_future();
+  state->subscribe(
+      TaskNode::create([self = std::move(*this), p = std::move(p), func = std::forward<F>(f)]() mutable {
+        if (self.state_->error()) {
+          p.set_exception(self.state_->error());
+        } else if constexpr (std::is_void_v<T>) {
+          p.set_from(func);
+        } else {
+          p.set_from(func, std::move(self.state_->value()));
+        }
+      }),
+      false);
+  return next;
+}
+
+template <typename T>
+template <typename F>
+void future<T>::subscribe(F&& f) {
+  check_state();
+  FutureState<T>* state = state_;
+  state->subscribe(TaskNode::create([self = std::move(*this), func = std::forward<F>(f)]() mutable {
+                     func(std::move(self));
+                   }),
+                   true);
+}
+
+template <typename T>
+future<std::decay_t<T>> make_ready_future(T&& value) {
+  promise<std::decay_t<T>> p;
+  p.set_value(std::forward<T>(value));
+  return p.get_future();
+}
+
+inline future<void> make_ready_future() {
+  promise<void> p;
+  p.set_value();
+  return p.get_future();
+}
+
+template <typename InputIt>
+using future_value_t = decltype(std::declval<typename std::iterator_traits<InputIt>::value_type&>().get());
+
+// Ready once every future in [first, last) is ready, with all the values in order,
+// or with the first exception. The futures are consumed.
+template <typename InputIt>
+auto when_all(InputIt first, InputIt last)
+    -> future<std::conditional_t<std::is_void_v<future_value_t<InputIt>>, void,
+                                 std::vector<future_value_t<InputIt>>>> {
+  using T = future_value_t<InputIt>;
+  using R = std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
+  using Slot = typename FutureState<T>::value_type;
+
+  struct Context {
+    std::atomic<size_t> remaining;
+    std::atomic<bool> failed;
+    std::vector<std::optional<Slot>> results;
+    promise<R> p;
+  };
+
+  size_t n = std::distance(first, last);
+  auto ctx = std::allocate_shared<Context>(pool_allocator<Context>());
+  ctx->remaining.store(n, std::memory_order_relaxed);
+  ctx->failed.store(false, std::memory_order_relaxed);
+  if constexpr (!std::is_void_v<T>) {
+    ctx->results.resize(n);
+  }
+  future<R> result = ctx->p.get_future();
+  if (n == 0) {
+    if constexpr (std::is_void_v<T>) {
+      ctx->p.set_value();
+    } else {
+      ctx->p.set_value(R());
+    }
+    return result;
+  }
+
+  for (size_t i = 0; first != last; ++first, ++i) {
+    std::move(*first).subscribe([ctx, i](future<T> f) {
+      try {
+        if constexpr (std::is_void_v<T>) {
+          f.get();
+        } else {
+          ctx->results[i].emplace(f.get());
+        }
+      } catch (...) {
+        if (!ctx->failed.exchange(true, std::memory_order_acq_rel)) {
+          ctx->p.set_exception(std::current_exception());
+        }
+      }
+      if (ctx->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+          !ctx->failed.load(std::memory_order_acquire)) {
+        if constexpr (std::is_void_v<T>) {
+          ctx->p.set_value();
+        } else {
+          R values;
+          values.reserve(ctx->results.size());
+          for (auto& v : ctx->results) {
+            values.push_back(std::move(*v));
+          }
+          ctx->p.set_value(std::move(values));
+        }
+      }
+    });
+  }
+  return result;
+}
+
+template <typename T>
+auto when_all(std::vector<future<T>>& futures) {
+  return when_all(futures.begin(), futures.end());
+}
+
+// Ready as soon as one future in [first, last) is ready, with its index (and its value),
+// or with its exception. The futures are consumed.
+template <typename InputIt>
+auto when_any(InputIt first, InputIt last)
+    -> future<std::conditional_t<std::is_void_v<future_value_t<InputIt>>, size_t,
+                                 std::pair<size_t, future_value_t<InputIt>>>> {
+  using T = future_value_t<InputIt>;
+  using R = std::conditional_t<std::is_void_v<T>, size_t, std::pair<size_t, T>>;
+
+  struct Context {
+    std::atomic<bool> done;
+    promise<R> p;
+  };
+
+  auto ctx = std::allocate_shared<Context>(pool_allocator<Context>());
+  ctx->done.store(false, std::memory_order_relaxed);
+  future<R> result = ctx->p.get_future();
+  if (first == last) {
+    ctx->p.set_exception(std::make_exception_ptr(std::invalid_argument("when_any of no future")));
+    return result;
+  }
+
+  for (size_t i = 0; first != last; ++first, ++i) {
+    std::move(*first).subscribe([ctx, i](future<T> f) {
+      if (ctx->done.exchange(true, std::memory_order_acq_rel)) {
+        return;
+      }
+      if constexpr (std::is_void_v<T>) {
+        ctx->p.set_from([&f, i]() {
+          f.get();
+          return i;
+        });
+      } else {
+        ctx->p.set_from([&f, i]() { return R(i, f.get()); });
+      }
+    });
+  }
+  return result;
+}
+
+template <typename T>
+auto when_any(std::vector<future<T>>& futures) {
+  return when_any(futures.begin(), futures.end());
+}
+
+}  // namespace hstl
+
+#endif  // FUTURE_HPP_
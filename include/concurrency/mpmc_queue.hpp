@@ -0,0 +1,253 @@
+#ifndef MPMC_QUEUE_HPP_
+#define MPMC_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "concurrency/cpu_relax.hpp"
+#include "concurrency/event_count.hpp"
+
+namespace hstl {
+
+// Bounded multi-producer multi-consumer queue (Vyukov's array queue). Every slot carries a
+// sequence number which says whose turn it is: slot i is free for the producer of position p
+// when its sequence is p, and full for the consumer of position p when it is p + 1. A push or
+// a pop is one CAS on the tail or head index plus a release store on the slot, producers and
+// consumers only meet on the slots. The head and the tail live on their own cache lines.
+//
+// try_* never block and fail on a full (empty) queue. push/pop spin for a while, then sleep on
+// an EventCount until a pop (push) makes room (an element); every operation notifies the other
+// side, which costs a fence when nobody sleeps. The *_n variants claim a run of consecutive
+// slots with a single CAS.
+template <typename T>
+class MpmcQueue {
+ public:
+  // the capacity is rounded up to a power of two
+  explicit MpmcQueue(size_t capacity) : head_(0), tail_(0) {
+    size_t n = 2;
+    while (n < capacity) {
+      n <<= 1;
+    }
+    mask_ = n - 1;
+    slots_ = std::make_unique<Slot[]>(n);
+    for (size_t i = 0; i < n; i++) {
+      slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpmcQueue(const MpmcQueue&) = delete;
+  MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+  ~MpmcQueue() {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    for (size_t pos = head_.load(std::memory_order_relaxed); pos != tail; pos++) {
+      std::launder(reinterpret_cast<T*>(slots_[pos & mask_].storage))->~T();
+    }
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+  // approximate, may be stale as soon as it returns
+  size_t size_approx() const {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+  }
+
+  template <typename... Args>
+  bool try_emplace(Args&&... args) {
+    size_t pos;
+    Slot* slot = claim(tail_, 0, pos);
+    if (slot == nullptr) {
+      return false;
+    }
+    ::new (static_cast<void*>(slot->storage)) T(std::forward<Args>(args)...);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    not_empty_.notify_one();
+    return true;
+  }
+  bool try_push(const T& value) { return try_emplace(value); }
+  bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+  bool try_pop(T& value) {
+    size_t pos;
+    Slot* slot = claim(head_, 1, pos);
+    if (slot == nullptr) {
+      return false;
+    }
+    take(slot, pos, [&value](T&& v) { value = std::move(v); });
+    not_full_.notify_one();
+    return true;
+  }
+
+  // Pushes *first, *(first + 1) ... (moved) as long as there is room, at most n; returns how
+  // many were pushed.
+  template <typename InputIt>
+  size_t try_push_n(InputIt first, size_t n) {
+    size_t pos;
+    size_t count = claim_n(tail_, 0, n, pos);
+    for (size_t i = 0; i < count; i++, ++first) {
+      Slot& slot = slots_[(pos + i) & mask_];
+      ::new (static_cast<void*>(slot.storage)) T(std::move(*first));
+      slot.seq.store(pos + i + 1, std::memory_order_release);
+    }
+    if (count > 0) {
+      notify(not_empty_, count);
+    }
+    return count;
+  }
+
+  // pops up to n elements into out, returns how many
+  template <typename OutputIt>
+  size_t try_pop_n(OutputIt out, size_t n) {
+    size_t pos;
+    size_t count = claim_n(head_, 1, n, pos);
+    for (size_t i = 0; i < count; i++) {
+      take(&slots_[(pos + i) & mask_], pos + i, [&out](T&& v) {
+        *out = std::move(v);
+        ++out;
+      });
+    }
+    if (count > 0) {
+      notify(not_full_, count);
+    }
+    return count;
+  }
+
+  void push(const T& value) {
+    wait_until(not_full_, [&]() { return try_push(value); });
+  }
+  void push(T&& value) {
+    wait_until(not_full_, [&]() { return try_push(std::move(value)); });
+  }
+  void pop(T& value) {
+    wait_until(not_empty_, [&]() { return try_pop(value); });
+  }
+
+  // pushes all n, waiting for room as needed
+  template <typename ForwardIt>
+  void push_n(ForwardIt first, size_t n) {
+    while (n > 0) {
+      size_t count = 0;
+      wait_until(not_full_, [&]() { return (count = try_push_n(first, n)) > 0; });
+      std::advance(first, count);
+      n -= count;
+    }
+  }
+
+  // waits for at least one element, then pops up to n; returns how many
+  template <typename OutputIt>
+  size_t pop_n(OutputIt out, size_t n) {
+    size_t count = 0;
+    wait_until(not_empty_, [&]() { return (count = try_pop_n(out, n)) > 0; });
+    return count;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> seq;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  static constexpr size_t kSpins = 64;
+
+  // Claims the next position of index (tail_ for producers with ahead 0, head_ for consumers
+  // with ahead 1), nullptr if the queue is full (empty).
+  Slot* claim(std::atomic<size_t>& index, size_t ahead, size_t& pos) {
+    pos = index.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot* slot = &slots_[pos & mask_];
+      size_t seq = slot->seq.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + ahead);
+      if (diff == 0) {
+        if (index.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          return slot;
+        }
+      } else if (diff < 0) {
+        return nullptr;
+      } else {
+        pos = index.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Claims up to n consecutive positions whose slots are all ready; the slots are completed
+  // out of order, so each one is checked before the single CAS.
+  size_t claim_n(std::atomic<size_t>& index, size_t ahead, size_t n, size_t& pos) {
+    pos = index.load(std::memory_order_relaxed);
+    for (;;) {
+      size_t count = 0;
+      while (count < n && count <= mask_) {
+        size_t seq = slots_[(pos + count) & mask_].seq.load(std::memory_order_acquire);
+        if (seq != pos + count + ahead) {
+          break;
+        }
+        count++;
+      }
+      if (count == 0) {
+        // full (empty), or another thread moved the index already
+        size_t now = index.load(std::memory_order_relaxed);
+        if (now == pos) {
+          return 0;
+        }
+        pos = now;
+        continue;
+      }
+      if (index.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+        return count;
+      }
+    }
+  }
+
+  // moves the element into sink(T&&) and frees the slot
+  template <typename Sink>
+  void take(Slot* slot, size_t pos, Sink&& sink) {
+    T* p = std::launder(reinterpret_cast<T*>(slot->storage));
+    sink(std::move(*p));
+    p->~T();
+    slot->seq.store(pos + mask_ + 1, std::memory_order_release);
+  }
+
+  static void notify(EventCount& ec, size_t count) {
+    if (count == 1) {
+      ec.notify_one();
+    } else {
+      ec.notify_all();
+    }
+  }
+
+  template <typename Try>
+  void wait_until(EventCount& ec, Try&& attempt) {
+    for (size_t i = 0; i < kSpins; i++) {
+      if (attempt()) {
+        return;
+      }
+      cpu_relax();
+    }
+    while (!attempt()) {
+      uint32_t key = ec.prepare_wait();
+      if (attempt()) {
+        ec.cancel_wait();
+        return;
+      }
+      ec.wait(key);
+    }
+  }
+
+  alignas(64) std::atomic<size_t> head_;
+  alignas(64) std::atomic<size_t> tail_;
+  alignas(64) size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  EventCount not_empty_;  // consumers sleep here
+  EventCount not_full_;   // producers sleep here
+};
+
+}  // namespace hstl
+
+#endif  // MPMC_QUEUE_HPP_
@@ -0,0 +1,275 @@
+#ifndef PARALLEL_HPP_
+#define PARALLEL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "concurrency/future.hpp"
+#include "concurrency/task_node.hpp"
+#include "concurrency/thread_pool.h"
+
+namespace hstl {
+
+namespace parallel_detail {
+
+// Runs body(begin, end) over sub-ranges of [0, n) on a ThreadPool.
+//
+// A range task splits itself in halves, posting the right half and keeping the left one,
+// until it is no longer than the grain or its split budget is used up. The initial budget
+// gives about 4 pieces per worker; a piece which was stolen by another thread gets a fresh
+// budget, so the ranges are cut finer only where the load is uneven (like the auto
+// partitioner of TBB). The calling thread runs the first piece itself and then helps the pool
+// until all pieces are done, which also makes nested calls from worker threads safe.
+template <typename Body>
+class ForState {
+ public:
+  ForState(ThreadPool& pool, size_t n, size_t grain, Body& body)
+      : pool_(pool), body_(body), grain_(std::max<size_t>(grain, 1)), remaining_(n),
+        failed_(false), done_(promise_.get_future()) {}
+
+  void run(size_t n) {
+    if (n == 0) {
+      return;
+    }
+    RangeTask(this, 0, n, initial_depth(), std::this_thread::get_id())();
+    // help instead of blocking, the missing pieces are queued or running somewhere; thieves
+    // keep splitting them, so there may be something to take until the very end
+    pool_.help_until([this]() { return done_.is_ready(); });
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+ private:
+  class RangeTask {
+   public:
+    RangeTask(ForState* state, size_t begin, size_t end, size_t depth, std::thread::id spawner)
+        : state_(state), begin_(begin), end_(end), depth_(depth), spawner_(spawner) {}
+
+    RangeTask(RangeTask&& other) noexcept
+        : state_(std::exchange(other.state_, nullptr)), begin_(other.begin_), end_(other.end_),
+          depth_(other.depth_), spawner_(other.spawner_) {}
+    RangeTask(const RangeTask&) = delete;
+
+    ~RangeTask() {
+      // discarded by a dying pool, the caller must not wait forever
+      if (state_ != nullptr) {
+        state_->finish(end_ - begin_,
+                       std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+      }
+    }
+
+    void operator()() {
+      ForState* s = std::exchange(state_, nullptr);
+      auto self = std::this_thread::get_id();
+      if (self != spawner_) {
+        depth_ += 2;
+      }
+      while (end_ - begin_ > s->grain_ && depth_ > 0) {
+        size_t mid = begin_ + (end_ - begin_) / 2;
+        depth_--;
+        s->pool_.post(TaskNode::create(RangeTask(s, mid, end_, depth_, self)));
+        end_ = mid;
+      }
+      std::exception_ptr e;
+      if (!s->failed_.load(std::memory_order_relaxed)) {
+        try {
+          s->body_(begin_, end_);
+        } catch (...) {
+          e = std::current_exception();
+        }
+      }
+      s->finish(end_ - begin_, std::move(e));
+    }
+
+   private:
+    ForState* state_;
+    size_t begin_;
+    size_t end_;
+    size_t depth_;
+    std::thread::id spawner_;
+  };
+
+  size_t initial_depth() const {
+    size_t depth = 2;
+    for (size_t p = 1; p < pool_.size(); p <<= 1) {
+      depth++;
+    }
+    return depth;
+  }
+
+  void finish(size_t count, std::exception_ptr e) {
+    if (e && !failed_.exchange(true, std::memory_order_acq_rel)) {
+      error_ = std::move(e);
+    }
+    if (remaining_.fetch_sub(count, std::memory_order_acq_rel) == count) {
+      promise_.set_value();
+    }
+  }
+
+  ThreadPool& pool_;
+  Body& body_;
+  size_t grain_;
+  std::atomic<size_t> remaining_;
+  std::atomic<bool> failed_;
+  std::exception_ptr error_;  // written by the first failing piece only
+  promise<void> promise_;
+  future<void> done_;
+};
+
+template <typename Body>
+void for_each_range(ThreadPool& pool, size_t n, size_t grain, Body&& body) {
+  ForState<std::remove_reference_t<Body>> state(pool, n, grain, body);
+  state.run(n);
+}
+
+template <typename T, typename = void>
+struct is_random_access : std::false_type {};
+
+template <typename T>
+struct is_random_access<T, std::void_t<typename std::iterator_traits<T>::iterator_category>>
+    : std::is_base_of<std::random_access_iterator_tag,
+                      typename std::iterator_traits<T>::iterator_category> {};
+
+template <typename T>
+using enable_if_index_t = std::enable_if_t<std::is_integral_v<T> || is_random_access<T>::value>;
+
+template <typename Index>
+auto element(Index first, size_t i) {
+  return first + static_cast<typename std::iterator_traits<Index>::difference_type>(i);
+}
+
+}  // namespace parallel_detail
+
+// f(i) for every i of [first, last) when Index is integral, f(*it) for every it of [first, last)
+// when it is a random access iterator (a raw pointer, hstl::vector::iterator, ...).
+// grain is the smallest number of elements run as one task, 0 picks one.
+// The first exception thrown by f is rethrown once all the other calls are done.
+template <typename Index, typename F, typename = parallel_detail::enable_if_index_t<Index>>
+void parallel_for(ThreadPool& pool, Index first, Index last, F&& f, size_t grain = 0) {
+  size_t n = last > first ? static_cast<size_t>(last - first) : 0;
+  parallel_detail::for_each_range(pool, n, grain, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      if constexpr (std::is_integral_v<Index>) {
+        f(static_cast<Index>(first + static_cast<Index>(i)));
+      } else {
+        f(*parallel_detail::element(first, i));
+      }
+    }
+  });
+}
+
+// f(x) for every element of a container with random access iterators, e.g. hstl::vector
+template <typename Range, typename F>
+void parallel_for(ThreadPool& pool, Range& range, F&& f) {
+  parallel_for(pool, range.begin(), range.end(), std::forward<F>(f));
+}
+
+// init op x0 op x1 op ... op xn-1, op must be associative (but needs not be commutative)
+template <typename RandomIt, typename T, typename BinaryOp = std::plus<>>
+T parallel_reduce(ThreadPool& pool, RandomIt first, RandomIt last, T init, BinaryOp op = BinaryOp(),
+                  size_t grain = 0) {
+  // one partial result per piece, ordered by the beginning of the piece at the end
+  std::mutex lock;
+  std::vector<std::pair<size_t, T>> partials;
+  parallel_detail::for_each_range(pool, std::distance(first, last), grain,
+                                  [&](size_t begin, size_t end) {
+    auto it = parallel_detail::element(first, begin);
+    T acc = *it;
+    for (size_t i = begin + 1; i < end; i++) {
+      acc = op(std::move(acc), *++it);
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    partials.emplace_back(begin, std::move(acc));
+  });
+  std::sort(partials.begin(), partials.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+  for (auto& p : partials) {
+    init = op(std::move(init), std::move(p.second));
+  }
+  return init;
+}
+
+template <typename Range, typename T, typename BinaryOp = std::plus<>,
+          typename = decltype(std::declval<const Range&>().begin())>
+T parallel_reduce(ThreadPool& pool, const Range& range, T init, BinaryOp op = BinaryOp()) {
+  return parallel_reduce(pool, range.begin(), range.end(), std::move(init), std::move(op));
+}
+
+// d_first[i] = f(first[i]), returns the end of the output range
+template <typename RandomIt, typename OutputIt, typename F>
+OutputIt parallel_transform(ThreadPool& pool, RandomIt first, RandomIt last, OutputIt d_first, F&& f,
+                            size_t grain = 0) {
+  size_t n = std::distance(first, last);
+  parallel_detail::for_each_range(pool, n, grain, [&](size_t begin, size_t end) {
+    auto in = parallel_detail::element(first, begin);
+    auto out = parallel_detail::element(d_first, begin);
+    for (size_t i = begin; i < end; i++, ++in, ++out) {
+      *out = f(*in);
+    }
+  });
+  return parallel_detail::element(d_first, n);
+}
+
+// d_first[i] = first[0] op ... op first[i], op must be associative. d_first may be first.
+//
+// Two passes over fixed blocks: the sum of every block is computed in parallel, the block
+// offsets are scanned serially, then every block is scanned in parallel from its offset.
+template <typename RandomIt, typename OutputIt, typename BinaryOp = std::plus<>>
+OutputIt parallel_inclusive_scan(ThreadPool& pool, RandomIt first, RandomIt last, OutputIt d_first,
+                                 BinaryOp op = BinaryOp(), size_t grain = 0) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  size_t n = std::distance(first, last);
+  if (n == 0) {
+    return d_first;
+  }
+  size_t block = std::max<size_t>({grain, n / (pool.size() * 4 + 1), 1});
+  size_t blocks = (n + block - 1) / block;
+
+  std::vector<std::optional<T>> sums(blocks);
+  parallel_detail::for_each_range(pool, blocks - 1, 1, [&](size_t begin, size_t end) {
+    // the last block is not needed by anyone
+    for (size_t b = begin; b < end; b++) {
+      auto it = parallel_detail::element(first, b * block);
+      T acc = *it;
+      for (size_t i = 1; i < block; i++) {
+        acc = op(std::move(acc), *++it);
+      }
+      sums[b].emplace(std::move(acc));
+    }
+  });
+  // sums[b] becomes the sum of the blocks before b + 1
+  for (size_t b = 1; b + 1 < blocks; b++) {
+    sums[b].emplace(op(*sums[b - 1], std::move(*sums[b])));
+  }
+
+  parallel_detail::for_each_range(pool, blocks, 1, [&](size_t begin, size_t end) {
+    for (size_t b = begin; b < end; b++) {
+      size_t from = b * block;
+      size_t to = std::min(n, from + block);
+      auto in = parallel_detail::element(first, from);
+      auto out = parallel_detail::element(d_first, from);
+      T acc = b == 0 ? T(*in) : op(*sums[b - 1], *in);
+      *out = acc;
+      for (size_t i = from + 1; i < to; i++) {
+        acc = op(std::move(acc), *++in);
+        *++out = acc;
+      }
+    }
+  });
+  return parallel_detail::element(d_first, n);
+}
+
+}  // namespace hstl
+
+#endif  // PARALLEL_HPP_
@@ -0,0 +1,306 @@
+#ifndef PARALLEL_SORT_HPP_
+#define PARALLEL_SORT_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "concurrency/parallel.hpp"
+#include "concurrency/thread_pool.h"
+
+namespace hstl {
+
+namespace parallel_detail {
+
+// below this many elements a range is sorted by the calling thread alone
+constexpr size_t kParallelSortCutoff = 1 << 14;
+constexpr ptrdiff_t kInsertionSortThreshold = 16;
+
+template <typename RandomIt, typename Compare>
+void insertion_sort(RandomIt first, RandomIt last, Compare& cmp) {
+  if (first == last) {
+    return;
+  }
+  for (RandomIt i = first + 1; i != last; ++i) {
+    auto value = std::move(*i);
+    RandomIt j = i;
+    for (; j != first && cmp(value, *(j - 1)); --j) {
+      *j = std::move(*(j - 1));
+    }
+    *j = std::move(value);
+  }
+}
+
+// moves the median of *a, *b, *c to *result
+template <typename RandomIt, typename Compare>
+void move_median_to_first(RandomIt result, RandomIt a, RandomIt b, RandomIt c, Compare& cmp) {
+  if (cmp(*a, *b)) {
+    if (cmp(*b, *c)) {
+      std::iter_swap(result, b);
+    } else if (cmp(*a, *c)) {
+      std::iter_swap(result, c);
+    } else {
+      std::iter_swap(result, a);
+    }
+  } else if (cmp(*a, *c)) {
+    std::iter_swap(result, a);
+  } else if (cmp(*b, *c)) {
+    std::iter_swap(result, c);
+  } else {
+    std::iter_swap(result, b);
+  }
+}
+
+// Hoare partition of [first + 1, last) around *first. Unguarded: the median of three leaves an
+// element not less and one not greater than the pivot in the range, which stop the scans.
+template <typename RandomIt, typename Compare>
+RandomIt partition_pivot(RandomIt first, RandomIt last, Compare& cmp) {
+  RandomIt mid = first + (last - first) / 2;
+  move_median_to_first(first, first + 1, mid, last - 1, cmp);
+  RandomIt lo = first + 1;
+  RandomIt hi = last;
+  while (true) {
+    while (cmp(*lo, *first)) {
+      ++lo;
+    }
+    --hi;
+    while (cmp(*first, *hi)) {
+      --hi;
+    }
+    if (!(lo < hi)) {
+      return lo;
+    }
+    std::iter_swap(lo, hi);
+    ++lo;
+  }
+}
+
+// Quicksort which recurses into the smaller side only and switches to heapsort after
+// 2 * log2(n) levels. Small partitions are insertion sorted right away, while they are still
+// in the cache.
+template <typename RandomIt, typename Compare>
+void introsort_loop(RandomIt first, RandomIt last, size_t depth, Compare& cmp) {
+  while (last - first > kInsertionSortThreshold) {
+    if (depth == 0) {
+      std::make_heap(first, last, cmp);
+      std::sort_heap(first, last, cmp);
+      return;
+    }
+    depth--;
+    RandomIt cut = partition_pivot(first, last, cmp);
+    if (cut - first < last - cut) {
+      introsort_loop(first, cut, depth, cmp);
+      first = cut;
+    } else {
+      introsort_loop(cut, last, depth, cmp);
+      last = cut;
+    }
+  }
+  insertion_sort(first, last, cmp);
+}
+
+template <typename RandomIt, typename Compare>
+void introsort(RandomIt first, RandomIt last, Compare& cmp) {
+  size_t depth = 0;
+  for (auto n = last - first; n > 1; n >>= 1) {
+    depth += 2;
+  }
+  introsort_loop(first, last, depth, cmp);
+}
+
+// blocks of about the same size, block b is [begin(b), begin(b + 1))
+struct Blocks {
+  size_t n;
+  size_t count;
+
+  size_t begin(size_t b) const { return n / count * b + std::min(b, n % count); }
+};
+
+template <typename T, typename Compare>
+constexpr bool is_radix_sortable =
+    std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+    (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<T>>);
+
+// LSD radix sort by bytes for integers in ascending order. Every pass counts the digits per
+// block, turns the counts into per-block offsets and scatters the blocks in parallel; a pass
+// whose digit is the same for all elements is skipped.
+template <typename RandomIt>
+void radix_sort(ThreadPool& pool, RandomIt first, size_t n) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  using U = std::make_unsigned_t<T>;
+  constexpr U kSignFlip = std::is_signed_v<T> ? U(1) << (std::numeric_limits<U>::digits - 1) : 0;
+  constexpr size_t kRadix = 256;
+
+  Blocks blocks{n, std::min(pool.size() * 4 + 1, n)};
+  std::vector<size_t> offsets(blocks.count * kRadix);
+  std::unique_ptr<T[]> buffer(new T[n]);
+  auto digit = [](T x, size_t shift) {
+    return static_cast<size_t>((static_cast<U>(x) ^ kSignFlip) >> shift) & (kRadix - 1);
+  };
+
+  // ping-pong between the input and the buffer
+  bool in_buffer = false;
+  auto pass = [&](auto src, auto dst, size_t shift) {
+    std::fill(offsets.begin(), offsets.end(), 0);
+    parallel_for(pool, size_t(0), blocks.count, [&](size_t b) {
+      size_t* count = &offsets[b * kRadix];
+      for (size_t i = blocks.begin(b); i < blocks.begin(b + 1); i++) {
+        count[digit(src[i], shift)]++;
+      }
+    }, 1);
+    size_t sum = 0;
+    for (size_t d = 0; d < kRadix; d++) {
+      size_t total = 0;
+      for (size_t b = 0; b < blocks.count; b++) {
+        size_t c = offsets[b * kRadix + d];
+        offsets[b * kRadix + d] = sum + total;
+        total += c;
+      }
+      if (total == n) {
+        return false;
+      }
+      sum += total;
+    }
+    parallel_for(pool, size_t(0), blocks.count, [&](size_t b) {
+      size_t* offset = &offsets[b * kRadix];
+      for (size_t i = blocks.begin(b); i < blocks.begin(b + 1); i++) {
+        dst[offset[digit(src[i], shift)]++] = src[i];
+      }
+    }, 1);
+    return true;
+  };
+  for (size_t shift = 0; shift < std::numeric_limits<U>::digits; shift += 8) {
+    bool moved = in_buffer ? pass(buffer.get(), first, shift) : pass(first, buffer.get(), shift);
+    if (moved) {
+      in_buffer = !in_buffer;
+    }
+  }
+  if (in_buffer) {
+    parallel_for(pool, size_t(0), blocks.count, [&](size_t b) {
+      std::copy(buffer.get() + blocks.begin(b), buffer.get() + blocks.begin(b + 1),
+                first + blocks.begin(b));
+    }, 1);
+  }
+}
+
+// Sample sort:
+//   1. pick buckets - 1 splitters from an oversampled, sorted random sample
+//   2. per block, find the bucket of every element and count the buckets (parallel)
+//   3. prefix sums give every (bucket, block) pair its place in a buffer
+//   4. move every block into the buffer (parallel)
+//   5. introsort every bucket and move it back (parallel)
+// Splitters are referenced by position and only used in step 2, before anything is moved.
+template <typename RandomIt, typename Compare>
+void sample_sort(ThreadPool& pool, RandomIt first, size_t n, Compare& cmp) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  constexpr size_t kOversampling = 16;
+
+  size_t buckets = std::min<size_t>(pool.size() * 4 + 1, std::numeric_limits<uint16_t>::max());
+  Blocks blocks{n, buckets};
+
+  std::vector<size_t> sample(buckets * kOversampling);
+  uint64_t seed = 0x9E3779B97F4A7C15ULL;
+  for (auto& s : sample) {
+    // xorshift64
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    s = seed % n;
+  }
+  auto by_value = [&](size_t a, size_t b) { return cmp(first[a], first[b]); };
+  introsort(sample.begin(), sample.end(), by_value);
+  std::vector<size_t> splitters(buckets - 1);
+  for (size_t k = 0; k + 1 < buckets; k++) {
+    splitters[k] = sample[(k + 1) * kOversampling];
+  }
+
+  std::vector<uint16_t> ids(n);
+  std::vector<size_t> offsets(blocks.count * buckets);
+  parallel_for(pool, size_t(0), blocks.count, [&](size_t b) {
+    size_t* count = &offsets[b * buckets];
+    for (size_t i = blocks.begin(b); i < blocks.begin(b + 1); i++) {
+      // upper bound among the splitters
+      auto it = std::upper_bound(splitters.begin(), splitters.end(), i,
+                                 [&](size_t x, size_t s) { return cmp(first[x], first[s]); });
+      ids[i] = static_cast<uint16_t>(it - splitters.begin());
+      count[ids[i]]++;
+    }
+  }, 1);
+
+  std::vector<size_t> bucket_begin(buckets + 1);
+  size_t sum = 0;
+  for (size_t k = 0; k < buckets; k++) {
+    bucket_begin[k] = sum;
+    for (size_t b = 0; b < blocks.count; b++) {
+      size_t c = offsets[b * buckets + k];
+      offsets[b * buckets + k] = sum;
+      sum += c;
+    }
+  }
+  bucket_begin[buckets] = n;
+
+  // raw storage, T needs not be default constructible; moves do not throw (see parallel_sort)
+  struct Buffer {
+    T* data;
+    size_t size = 0;  // number of constructed elements
+    explicit Buffer(size_t n)
+        : data(static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))))) {}
+    ~Buffer() {
+      std::destroy(data, data + size);
+      ::operator delete(data, std::align_val_t(alignof(T)));
+    }
+  } buffer(n);
+
+  parallel_for(pool, size_t(0), blocks.count, [&](size_t b) {
+    size_t* offset = &offsets[b * buckets];
+    for (size_t i = blocks.begin(b); i < blocks.begin(b + 1); i++) {
+      ::new (static_cast<void*>(buffer.data + offset[ids[i]]++)) T(std::move(first[i]));
+    }
+  }, 1);
+  buffer.size = n;
+
+  parallel_for(pool, size_t(0), buckets, [&](size_t k) {
+    T* lo = buffer.data + bucket_begin[k];
+    T* hi = buffer.data + bucket_begin[k + 1];
+    introsort(lo, hi, cmp);
+    std::move(lo, hi, first + bucket_begin[k]);
+  }, 1);
+}
+
+}  // namespace parallel_detail
+
+// Sorts [first, last) with cmp on pool, not stable. Small ranges are introsorted by the calling
+// thread, integers compared with std::less take a parallel radix sort, everything else a
+// parallel sample sort (which needs an extra n elements of memory). Types whose move
+// constructor may throw are sorted by the calling thread.
+template <typename RandomIt, typename Compare = std::less<>>
+void parallel_sort(ThreadPool& pool, RandomIt first, RandomIt last, Compare cmp = Compare()) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  size_t n = last > first ? static_cast<size_t>(last - first) : 0;
+  if (n < parallel_detail::kParallelSortCutoff || !std::is_nothrow_move_constructible_v<T>) {
+    parallel_detail::introsort(first, last, cmp);
+  } else if constexpr (parallel_detail::is_radix_sortable<T, Compare>) {
+    parallel_detail::radix_sort(pool, first, n);
+  } else {
+    parallel_detail::sample_sort(pool, first, n, cmp);
+  }
+}
+
+// sorts a container with random access iterators, e.g. hstl::vector
+template <typename Range, typename Compare = std::less<>,
+          typename = decltype(std::declval<Range&>().begin())>
+void parallel_sort(ThreadPool& pool, Range& range, Compare cmp = Compare()) {
+  parallel_sort(pool, range.begin(), range.end(), std::move(cmp));
+}
+
+}  // namespace hstl
+
+#endif  // PARALLEL_SORT_HPP_
@@ -0,0 +1,82 @@
+#ifndef RING_BUFFER_HPP_
+#define RING_BUFFER_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace hstl {
+
+// A double-ended queue in one power-of-two array, indexed from the front. Pushing at the back
+// and popping at either end are O(1); the array doubles when it is full and never shrinks, so
+// a buffer reserved for its peak size does not allocate any more. Not thread safe.
+template <typename T>
+class RingBuffer {
+ public:
+  RingBuffer() : head_(0), size_(0), capacity_(0) {}
+
+  RingBuffer(const RingBuffer&) = delete;
+  RingBuffer& operator=(const RingBuffer&) = delete;
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t capacity() const { return capacity_; }
+
+  T& operator[](size_t i) { return slots_[(head_ + i) & (capacity_ - 1)]; }
+  const T& operator[](size_t i) const { return slots_[(head_ + i) & (capacity_ - 1)]; }
+  T& front() { return (*this)[0]; }
+  T& back() { return (*this)[size_ - 1]; }
+
+  void push_back(T value) {
+    if (size_ == capacity_) {
+      reserve(capacity_ == 0 ? 16 : capacity_ * 2);
+    }
+    (*this)[size_++] = std::move(value);
+  }
+
+  // the buffer must not be empty
+  T pop_front() {
+    T value = std::move(front());
+    head_ = (head_ + 1) & (capacity_ - 1);
+    size_--;
+    return value;
+  }
+  T pop_back() {
+    T value = std::move(back());
+    size_--;
+    return value;
+  }
+
+  void clear() {
+    head_ = 0;
+    size_ = 0;
+  }
+
+  // room for capacity elements, rounded up to a power of two
+  void reserve(size_t capacity) {
+    size_t n = capacity_ == 0 ? 1 : capacity_;
+    while (n < capacity) {
+      n <<= 1;
+    }
+    if (n == capacity_) {
+      return;
+    }
+    auto slots = std::make_unique<T[]>(n);
+    for (size_t i = 0; i < size_; i++) {
+      slots[i] = std::move((*this)[i]);
+    }
+    slots_ = std::move(slots);
+    head_ = 0;
+    capacity_ = n;
+  }
+
+ private:
+  std::unique_ptr<T[]> slots_;
+  size_t head_;
+  size_t size_;
+  size_t capacity_;
+};
+
+}  // namespace hstl
+
+#endif  // RING_BUFFER_HPP_
@@ -0,0 +1,193 @@
+#ifndef SMALL_OBJECT_POOL_HPP_
+#define SMALL_OBJECT_POOL_HPP_
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace hstl {
+
+// Size-class freelists for the small, short-lived objects of the thread pool
+// (task nodes, future shared states).
+//
+// Every thread keeps a freelist per size class, allocation and deallocation on the
+// same thread never lock. Objects are often freed on another thread than the one that
+// allocated them (e.g. a task is created by the producer and freed by a worker), so a
+// freelist which grows too long hands a batch of blocks over to a global depot, and an
+// empty freelist takes a batch from the depot before falling back to operator new.
+class SmallObjectPool {
+ public:
+  static constexpr size_t kAlign = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+  // larger requests go straight to operator new
+  static constexpr size_t kMaxSize = 1024;
+
+  static void* allocate(size_t size) {
+    if (size > kMaxSize) {
+      return ::operator new(size);
+    }
+    size_t idx = index(size);
+    Cache* c = cache();
+    if (c == nullptr) {
+      return ::operator new((idx + 1) * kAlign);
+    }
+    if (c->head[idx] == nullptr) {
+      refill(*c, idx);
+    }
+    Block* b = c->head[idx];
+    if (b == nullptr) {
+      return ::operator new((idx + 1) * kAlign);
+    }
+    c->head[idx] = b->next;
+    c->count[idx]--;
+    return b;
+  }
+
+  static void deallocate(void* p, size_t size) noexcept {
+    Cache* c = size > kMaxSize ? nullptr : cache();
+    if (c == nullptr) {
+      ::operator delete(p);
+      return;
+    }
+    size_t idx = index(size);
+    Block* b = static_cast<Block*>(p);
+    b->next = c->head[idx];
+    c->head[idx] = b;
+    if (++c->count[idx] >= 2 * kBatch) {
+      flush(*c, idx);
+    }
+  }
+
+ private:
+  static constexpr size_t kClassCount = kMaxSize / kAlign;
+  // number of blocks moved between a thread cache and the depot at once
+  static constexpr size_t kBatch = 32;
+
+  struct Block {
+    Block* next;
+  };
+
+  static void free_list(Block* b) noexcept {
+    while (b != nullptr) {
+      Block* next = b->next;
+      ::operator delete(b);
+      b = next;
+    }
+  }
+
+  // Blocks are still freed by thread_local and static destructors which run after the cache of
+  // their thread (e.g. a namespace-scope ThreadPool discarding its tasks at exit, after the
+  // thread_locals of the main thread). The cache then says so in cache_destroyed(), a trivially
+  // destructible thread_local which stays valid, and the pool falls back to operator new/delete.
+  struct Cache {
+    Block* head[kClassCount] = {};
+    size_t count[kClassCount] = {};
+    ~Cache() {
+      for (size_t i = 0; i < kClassCount; i++) {
+        free_list(head[i]);
+        head[i] = nullptr;
+        count[i] = 0;
+      }
+      cache_destroyed() = true;
+    }
+  };
+
+  struct Depot {
+    std::mutex lock;
+    // every entry is a list of kBatch blocks
+    std::vector<Block*> batches[kClassCount];
+  };
+
+  static size_t index(size_t size) { return size == 0 ? 0 : (size - 1) / kAlign; }
+
+  static bool& cache_destroyed() {
+    thread_local bool destroyed = false;
+    return destroyed;
+  }
+
+  // null once the cache of this thread has been destroyed
+  static Cache* cache() {
+    if (cache_destroyed()) {
+      return nullptr;
+    }
+    thread_local Cache c;
+    return &c;
+  }
+
+  // never destroyed, threads may flush into it until the very end of the process
+  static Depot& depot() {
+    static Depot* d = new Depot;
+    return *d;
+  }
+
+  static void refill(Cache& c, size_t idx) {
+    Depot& d = depot();
+    std::lock_guard<std::mutex> guard(d.lock);
+    if (!d.batches[idx].empty()) {
+      c.head[idx] = d.batches[idx].back();
+      c.count[idx] = kBatch;
+      d.batches[idx].pop_back();
+    }
+  }
+
+  static void flush(Cache& c, size_t idx) noexcept {
+    Block* first = c.head[idx];
+    Block* last = first;
+    for (size_t i = 1; i < kBatch; i++) {
+      last = last->next;
+    }
+    c.head[idx] = last->next;
+    c.count[idx] -= kBatch;
+    last->next = nullptr;
+
+    Depot& d = depot();
+    std::lock_guard<std::mutex> guard(d.lock);
+    try {
+      d.batches[idx].push_back(first);
+    } catch (...) {
+      free_list(first);
+    }
+  }
+};
+
+// std compatible allocator on top of SmallObjectPool,
+// e.g. for std::promise(std::allocator_arg, pool_allocator<char>())
+template <typename T>
+class pool_allocator {
+ public:
+  using value_type = T;
+
+  pool_allocator() noexcept = default;
+  template <typename U>
+  pool_allocator(const pool_allocator<U>&) noexcept {}
+
+  T* allocate(size_t n) {
+    if constexpr (alignof(T) > SmallObjectPool::kAlign) {
+      return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    } else {
+      return static_cast<T*>(SmallObjectPool::allocate(n * sizeof(T)));
+    }
+  }
+
+  void deallocate(T* p, size_t n) noexcept {
+    if constexpr (alignof(T) > SmallObjectPool::kAlign) {
+      ::operator delete(p, std::align_val_t(alignof(T)));
+    } else {
+      SmallObjectPool::deallocate(p, n * sizeof(T));
+    }
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const pool_allocator<T>&, const pool_allocator<U>&) noexcept {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const pool_allocator<T>&, const pool_allocator<U>&) noexcept {
+  return false;
+}
+
+}  // namespace hstl
+
+#endif  // SMALL_OBJECT_POOL_HPP_
@@ -0,0 +1,166 @@
+#ifndef TASK_GROUP_HPP_
+#define TASK_GROUP_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include "concurrency/task_node.hpp"
+#include "concurrency/thread_pool.h"
+
+namespace hstl {
+
+class task_group;
+
+// Lets a task of a task_group see that the group was cancelled, e.g. to stop a long loop
+// early. A default constructed token is never cancelled. Valid while its group lives.
+class cancellation_token {
+ public:
+  cancellation_token() noexcept = default;
+
+  bool is_cancelled() const noexcept {
+    return flag_ != nullptr && flag_->load(std::memory_order_relaxed);
+  }
+
+ private:
+  friend class task_group;
+  explicit cancellation_token(const std::atomic<bool>* flag) noexcept : flag_(flag) {}
+
+  const std::atomic<bool>* flag_ = nullptr;
+};
+
+enum class task_group_status {
+  complete,  // every task ran
+  canceled,  // the group was cancelled, the tasks which had not started were skipped
+};
+
+// A scope for a family of tasks on a ThreadPool (structured concurrency): run() adds a task,
+// wait() returns once all of them are done. The tasks are counted by a single atomic, no
+// future per task.
+//
+// cancel() makes the tasks which have not started yet finish without running, the running
+// ones can poll the cancellation_token they may take as their argument. The first exception
+// of a task cancels the group too, wait() rethrows it. A task discarded by a dying pool counts
+// as failed with future_error(broken_promise).
+//
+// Tasks may add more tasks to their own group. The group must outlive its tasks: the
+// destructor cancels and waits for whatever is left.
+class task_group {
+ public:
+  explicit task_group(ThreadPool& pool, Priority priority = Priority::normal)
+      : pool_(pool), priority_(priority), pending_(0), cancelled_(false), failed_(false) {}
+
+  task_group(const task_group&) = delete;
+  task_group& operator=(const task_group&) = delete;
+
+  ~task_group() {
+    cancel();
+    try {
+      wait();
+    } catch (...) {
+    }
+  }
+
+  // f() or f(cancellation_token)
+  template <typename F>
+  void run(F&& f) {
+    TaskNode* task = TaskNode::create(GroupTask<std::decay_t<F>>(this, std::forward<F>(f)));
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    pool_.post(task, priority_);
+  }
+
+  void cancel() noexcept { cancelled_.store(true, std::memory_order_relaxed); }
+  bool is_cancelled() const noexcept { return cancelled_.load(std::memory_order_relaxed); }
+  cancellation_token token() const noexcept { return cancellation_token(&cancelled_); }
+
+  // Blocks until every task of the group is done. The calling thread runs queued tasks of the
+  // pool meanwhile (any of them, not only the group's), so waiting on a worker is safe. Then
+  // rethrows the first exception of a task if any, and resets the group for reuse.
+  task_group_status wait() {
+    pool_.help_until([this]() { return pending_.load(std::memory_order_acquire) == 0; });
+    // the last task leaves the lock after its final decrement, the group can go after this
+    { std::lock_guard<std::mutex> guard(lock_); }
+
+    bool cancelled = cancelled_.exchange(false, std::memory_order_relaxed);
+    if (failed_.exchange(false, std::memory_order_acquire)) {
+      std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+    return cancelled ? task_group_status::canceled : task_group_status::complete;
+  }
+
+ private:
+  template <typename F>
+  class GroupTask {
+   public:
+    GroupTask(task_group* group, F&& f) : group_(group), f_(std::move(f)) {}
+    GroupTask(task_group* group, const F& f) : group_(group), f_(f) {}
+
+    GroupTask(GroupTask&& other) noexcept(std::is_nothrow_move_constructible_v<F>)
+        : group_(std::exchange(other.group_, nullptr)), f_(std::move(other.f_)) {}
+    GroupTask(const GroupTask&) = delete;
+
+    ~GroupTask() {
+      // discarded by a dying pool
+      if (group_ != nullptr) {
+        group_->finish(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+      }
+    }
+
+    void operator()() {
+      task_group* group = std::exchange(group_, nullptr);
+      std::exception_ptr e;
+      // checked before the start only, a running task polls its token itself
+      if (!group->is_cancelled()) {
+        try {
+          if constexpr (std::is_invocable_v<F&, cancellation_token>) {
+            f_(group->token());
+          } else {
+            f_();
+          }
+        } catch (...) {
+          e = std::current_exception();
+        }
+      }
+      group->finish(std::move(e));
+    }
+
+   private:
+    task_group* group_;
+    F f_;
+  };
+
+  void finish(std::exception_ptr e) {
+    if (e) {
+      if (!failed_.exchange(true, std::memory_order_acq_rel)) {
+        error_ = std::move(e);
+      }
+      cancel();
+    }
+    // only the last task takes the lock, it decrements under it so that wait() cannot return
+    // (and destroy the group) while the task is still in here
+    size_t n = pending_.load(std::memory_order_relaxed);
+    while (n > 1) {
+      if (pending_.compare_exchange_weak(n, n - 1, std::memory_order_acq_rel)) {
+        return;
+      }
+    }
+    std::lock_guard<std::mutex> guard(lock_);
+    pending_.fetch_sub(1, std::memory_order_acq_rel);
+  }
+
+  ThreadPool& pool_;
+  Priority priority_;
+  std::atomic<size_t> pending_;
+  std::atomic<bool> cancelled_;
+  std::atomic<bool> failed_;
+  std::exception_ptr error_;  // written by the first failing task only
+  std::mutex lock_;
+};
+
+}  // namespace hstl
+
+#endif  // TASK_GROUP_HPP_
@@ -0,0 +1,105 @@
+#ifndef TASK_NODE_HPP_
+#define TASK_NODE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "concurrency/small_object_pool.hpp"
+
+namespace hstl {
+
+// A type erased, move-only void() callable which lives in a fixed size node taken from
+// SmallObjectPool. Callables up to kInlineSize bytes are stored inside the node (SBO),
+// bigger or over-aligned ones get a second block from pool_allocator.
+//
+// A node is created by create() and is consumed exactly once, by run() or discard().
+class TaskNode {
+ public:
+  static constexpr size_t kNodeSize = 128;
+  static constexpr size_t kInlineSize = kNodeSize - alignof(std::max_align_t);
+
+  template <typename F>
+  static TaskNode* create(F&& f) {
+    using Func = std::decay_t<F>;
+    void* mem = SmallObjectPool::allocate(sizeof(TaskNode));
+    TaskNode* node = ::new (mem) TaskNode(&ops<Func>);
+    try {
+      if constexpr (is_inline<Func>) {
+        ::new (static_cast<void*>(node->storage_)) Func(std::forward<F>(f));
+      } else {
+        Func* p = pool_allocator<Func>().allocate(1);
+        try {
+          ::new (static_cast<void*>(p)) Func(std::forward<F>(f));
+        } catch (...) {
+          pool_allocator<Func>().deallocate(p, 1);
+          throw;
+        }
+        *reinterpret_cast<Func**>(node->storage_) = p;
+      }
+    } catch (...) {
+      SmallObjectPool::deallocate(mem, sizeof(TaskNode));
+      throw;
+    }
+    return node;
+  }
+
+  TaskNode(const TaskNode&) = delete;
+  TaskNode& operator=(const TaskNode&) = delete;
+
+  // run the callable, then destroy it and give the node back to the pool
+  void run() { ops_(this, true); }
+  // destroy the callable without running it
+  void discard() { ops_(this, false); }
+
+  // a word for the executor, ThreadPool keeps the time of post() there for its statistics;
+  // it fills the padding in front of the storage, the node does not grow
+  void set_stamp(uint64_t stamp) { stamp_ = stamp; }
+  uint64_t stamp() const { return stamp_; }
+
+ private:
+  using Ops = void (*)(TaskNode*, bool);
+
+  template <typename Func>
+  static constexpr bool is_inline =
+      sizeof(Func) <= kInlineSize && alignof(Func) <= alignof(std::max_align_t);
+
+  explicit TaskNode(Ops ops) : ops_(ops) {}
+
+  template <typename Func>
+  static void ops(TaskNode* node, bool run) {
+    Func* f;
+    if constexpr (is_inline<Func>) {
+      f = std::launder(reinterpret_cast<Func*>(node->storage_));
+    } else {
+      f = *reinterpret_cast<Func**>(node->storage_);
+    }
+    // release the callable and the node even if f throws
+    struct Guard {
+      TaskNode* node;
+      Func* f;
+      ~Guard() {
+        f->~Func();
+        if constexpr (!is_inline<Func>) {
+          pool_allocator<Func>().deallocate(f, 1);
+        }
+        SmallObjectPool::deallocate(node, sizeof(TaskNode));
+      }
+    } guard{node, f};
+    if (run) {
+      (*f)();
+    }
+  }
+
+  Ops ops_;
+  uint64_t stamp_ = 0;
+  alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+};
+
+static_assert(sizeof(TaskNode) == TaskNode::kNodeSize, "TaskNode must fill exactly one pool block");
+
+}  // namespace hstl
+
+#endif  // TASK_NODE_HPP_
@@ -1,145 +1,1676 @@
 #ifndef THREAD_POOL_H_
 #define THREAD_POOL_H_
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <exception>
 #include <functional>
 #include <future>
+#include <iterator>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
 #include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
-#include <queue>
-#include <iostream>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+// C++20 builds get ThreadPool::schedule() and concurrency/coroutine.hpp
+#define HSTL_COROUTINES 1
+#endif
+
+#include "concurrency/batch.hpp"
+#include "concurrency/cpu_relax.hpp"
+#include "concurrency/cpu_topology.hpp"
+#include "concurrency/error_ring.hpp"
+#include "concurrency/executor.hpp"
+#include "concurrency/future.hpp"
+#include "concurrency/ring_buffer.hpp"
+#include "concurrency/small_object_pool.hpp"
+#include "concurrency/task_node.hpp"
+#include "concurrency/thread_pool_stats.hpp"
+#include "concurrency/timer_wheel.hpp"
+#include "concurrency/work_stealing_deque.hpp"
 
 namespace hstl {
- 
-class ThreadPool {
+
+// What a worker does when it runs out of tasks: `spin` rounds of checking for new tasks with
+// a pause instruction in between, then `yield` rounds with std::this_thread::yield(), then it
+// parks until a submitter wakes it up. Spinning trades CPU time for wake-up latency.
+struct IdlePolicy {
+  size_t spin = 128;
+  size_t yield = 8;
+
+  // park as soon as there is no task, no CPU is burnt while idle
+  static IdlePolicy park() { return {0, 0}; }
+  static IdlePolicy spin_then_park() { return {}; }
+  // (almost) never park, lowest latency, an idle pool keeps all its cores busy
+  static IdlePolicy busy_spin() { return {static_cast<size_t>(-1), 0}; }
+};
+
+// Priority class of a task. Workers serve the highest class which has work first, both from
+// their own queues and when stealing.
+enum class Priority : uint8_t {
+  high = 0,
+  normal = 1,
+  low = 2,
+};
+
+constexpr size_t kPriorityLevels = 3;
+
+// Elastic mode, enabled by max_threads > 0: the pool starts with thread_num workers and adds
+// one (up to max_threads) when more than queue_depth tasks per worker are waiting at a
+// submission, or when tasks have been waiting for stall_timeout without any worker taking one
+// (e.g. all of them block in I/O). A worker which stayed idle for idle_timeout exits, down to
+// min_threads.
+struct ElasticPolicy {
+  size_t max_threads = 0;
+  size_t min_threads = 1;
+  size_t queue_depth = 16;
+  std::chrono::milliseconds stall_timeout{10};
+  std::chrono::milliseconds idle_timeout{1000};
+};
+
+// What submit() and async() from a thread outside the pool do when ThreadPoolOptions::capacity
+// tasks are already queued.
+enum class OverflowPolicy : uint8_t {
+  block,        // wait until a worker takes a task
+  fail,         // throw std::runtime_error
+  caller_runs,  // run the task on the calling thread, which slows the producer down
+  drop_oldest,  // discard the oldest queued task (its future gets broken_promise)
+};
+
+// result of ThreadPool::try_submit
+enum class SubmitStatus : uint8_t {
+  ok,
+  full,    // capacity tasks are queued
+  closed,  // see ThreadPool::close
+};
+
+struct ThreadPoolOptions {
+  IdlePolicy idle;
+  // Aging: once a worker has taken this many tasks while a lower class was waiting, it
+  // serves the classes from the lowest up for one task, so low priority work cannot starve.
+  size_t aging_interval = 32;
+  // Worker i is pinned to cpus[i % cpus.size()]. With pin_workers and no cpus, the workers are
+  // pinned to the CPUs of CpuTopology::detect(), filling one NUMA node after the other.
+  // Either way stealing visits the workers of the same node first.
+  std::vector<int> cpus;
+  bool pin_workers = false;
+  ElasticPolicy elastic;
+  // per-worker counters and latency histograms for stats(), about 8KB per worker slot and
+  // two clock reads per task; see also HSTL_THREAD_POOL_STATS
+  bool collect_stats = false;
+  // What becomes of an exception escaping a task (submit & co. keep theirs in the future, this
+  // is about post(), periodic timers and the like). By default it is dropped, and counted in
+  // the statistics. on_error is called on the thread which ran the task and must not throw;
+  // with error_ring_capacity > 0 the errors are kept for ThreadPool::drain_errors(), the ones
+  // which do not fit are counted by dropped_errors(). Both may be set.
+  std::function<void(std::exception_ptr)> on_error;
+  size_t error_ring_capacity = 0;
+  // Bounded mode, capacity > 0: at most capacity tasks wait in the queues, submissions from
+  // threads outside the pool beyond that follow overflow. For submit_n and submit_batch block
+  // and drop_oldest apply chunk by chunk, caller_runs runs the tasks which find no slot, and
+  // fail rejects a batch which does not fit as a whole. Tasks posted by the workers (nested
+  // tasks, continuations, batches) and timers count but are never held back, a worker must
+  // not wait for itself. The queues are allocated for capacity up front.
+  size_t capacity = 0;
+  OverflowPolicy overflow = OverflowPolicy::block;
+};
+
+class ThreadPool;
+
+namespace timer_detail {
+
+// A timer of ThreadPool::submit_after & co. Linked in the wheel of its pool while armed, the
+// wheel's reference is then held by self.
+struct TimerEntry : TimerWheelNode {
+  std::shared_ptr<TimerEntry> self;
+  Priority priority = Priority::normal;
+  uint64_t period = 0;              // in ticks, 0 for a one-shot timer
+  bool cancelled = false;           // guarded by the timer lock of the pool
+  TaskNode *task = nullptr;         // one-shot: posted when the timer fires
+  void (*run)(TimerEntry &) = nullptr;  // periodic: called at every period
+};
+
+template<typename Func>
+struct PeriodicTimer : TimerEntry {
+  explicit PeriodicTimer(Func &&f) : func(std::move(f)) {
+    run = [](TimerEntry &e) { static_cast<PeriodicTimer &>(e).func(); };
+  }
+  Func func;
+};
+
+}
+
+// Cancels a timer of ThreadPool::submit_after, submit_at or submit_every. Copyable, a default
+// constructed handle refers to no timer. Must not be used after the pool is destroyed.
+class TimerHandle {
+public:
+  TimerHandle() = default;
+
+  // Stops the timer, false if it has already fired (one-shot) or was cancelled before. A run
+  // which has started is not interrupted, but a periodic timer is not armed again after it.
+  bool cancel();
+
+private:
+  friend class ThreadPool;
+  TimerHandle(ThreadPool *pool, std::weak_ptr<timer_detail::TimerEntry> entry)
+  : pool_(pool), entry_(std::move(entry)) {}
+
+  ThreadPool *pool_ = nullptr;
+  std::weak_ptr<timer_detail::TimerEntry> entry_;
+};
+
+class ThreadPool : public Executor {
 public:
-  using Task = std::function<void()>;
-
-  ThreadPool(size_t thread_num): closed_(false), queues_(thread_num), threads_(thread_num) {
-    for (int i = 0; i < thread_num; i++) {
-      threads_[i] = std::thread([this, i]() {
-        while (!closed_.load(std::memory_order_acquire)) { // sync point
-          Task f = get_one_task(i);
-          if (f == nullptr) {
-            auto &queue = queues_[i];
-            std::unique_lock guard(queue.lock);
-            queue.cv.wait(guard, [this, &queue]() { return !queue.q.empty() || closed_.load(std::memory_order_relaxed); });
-            continue;
+  using Task = TaskNode;
+
+  // Worker slots are allocated up front for the largest size the pool can reach, so the
+  // queues and the steal victims never move while the pool runs; an elastic pool only starts
+  // and stops threads on the slots [0, active_).
+  ThreadPool(size_t thread_num, const ThreadPoolOptions &options = ThreadPoolOptions())
+  : options_(options), closed_(false), stop_(false), pending_(), outstanding_(0), queued_(0),
+    slot_waiters_(0), sleepers_(0),
+    drain_waiters_(0), next_(0), active_(thread_num), epoch_(std::chrono::steady_clock::now()),
+    timer_count_(0), timekeeper_(kNoKeeper), timer_wakeup_(TimerWheel::kNever),
+    workers_(std::max(thread_num, options.elastic.max_threads)),
+    threads_(workers_.size()) {
+    idle_.reserve(workers_.size());
+    place_workers();
+    if (collecting()) {
+      for (auto &w: workers_) {
+        w.stats = std::make_unique<WorkerStats>();
+      }
+      helper_stats_ = std::make_unique<WorkerStats>(true);
+    }
+    if (is_bounded()) {
+      // every worker has room for its share of the capacity, more grows the queues
+      size_t share = (options_.capacity + workers_.size() - 1) / workers_.size();
+      for (auto &w: workers_) {
+        for (auto &level: w.levels) {
+          level.deque.reserve(share);
+          level.inbox.reserve(share);
+        }
+      }
+    }
+    if (options_.error_ring_capacity > 0) {
+      errors_ = std::make_unique<ErrorRing>(options_.error_ring_capacity);
+    }
+    for (size_t i = 0; i < thread_num; i++) {
+      threads_[i] = std::thread([this, i]() { worker_loop(i); });
+    }
+    if (is_elastic()) {
+      monitor_ = std::thread([this]() { monitor_loop(); });
+    }
+  }
+
+  // tasks which were never picked up are discarded, their futures get broken_promise
+  ~ThreadPool() { shutdown_now(); }
+
+  template<typename F, typename... Args, typename R = std::invoke_result_t<F, Args...>>
+  auto submit(F&& f, Args&&... args) -> std::future<R> {
+    return submit(Priority::normal, std::forward<F>(f), std::forward<Args>(args)...);
+  }
+
+  template<typename F, typename... Args, typename R = std::invoke_result_t<F, Args...>>
+  auto submit(Priority priority, F&& f, Args&&... args) -> std::future<R>;
+
+  // like submit, but never waits and never throws for a full or closed pool: the future is
+  // only valid with SubmitStatus::ok
+  template<typename F, typename... Args, typename R = std::invoke_result_t<F, Args...>>
+  auto try_submit(F&& f, Args&&... args) -> std::pair<SubmitStatus, std::future<R>> {
+    return try_submit(Priority::normal, std::forward<F>(f), std::forward<Args>(args)...);
+  }
+
+  template<typename F, typename... Args, typename R = std::invoke_result_t<F, Args...>>
+  auto try_submit(Priority priority, F&& f, Args&&... args) -> std::pair<SubmitStatus, std::future<R>>;
+
+  // like submit, but returns hstl::future whose continuations (then) run on this pool
+  template<typename F, typename... Args, typename R = std::invoke_result_t<F, Args...>>
+  auto async(F&& f, Args&&... args) -> future<R> {
+    return async(Priority::normal, std::forward<F>(f), std::forward<Args>(args)...);
+  }
+
+  template<typename F, typename... Args, typename R = std::invoke_result_t<F, Args...>>
+  auto async(Priority priority, F&& f, Args&&... args) -> future<R>;
+
+  // Runs f(0) ... f(count - 1). The tasks are spread over the workers with one lock per
+  // worker and one wake-up pass, the returned future is ready once all of them have run
+  // (or holds the first exception). In bounded mode see ThreadPoolOptions::capacity.
+  template<typename F>
+  future<void> submit_n(size_t count, F&& f, Priority priority = Priority::normal);
+
+  // runs every callable of [first, last) (moved out of the range), see submit_n; the range is
+  // walked twice, once to count the tasks
+  template<typename ForwardIt>
+  future<void> submit_batch(ForwardIt first, ForwardIt last, Priority priority = Priority::normal);
+
+  // low level: queue a task node, which is run() by a worker or discard()ed at shutdown_now()
+  // (right away if the workers are already gone)
+  void post(Task *task) override { post(task, Priority::normal); }
+  void post(Task *task, Priority priority);
+
+  // Run f once after delay, once at time, or every period (the first time one period from
+  // now) on this pool. The timers live in a TimerWheel with 1ms ticks which the workers
+  // advance themselves, no thread is added: a parked worker sleeps until the next timer, busy
+  // workers look at the timers between tasks. A timer never fires early, but late when all
+  // the workers are busy with long tasks. A periodic timer keeps its phase, skips the runs it
+  // missed and never overlaps with itself.
+  //
+  // Timers are not tasks for wait_idle(), they are dropped at shutdown (a one-shot callable is
+  // destroyed without running).
+  template<typename F>
+  TimerHandle submit_after(std::chrono::nanoseconds delay, F&& f, Priority priority = Priority::normal) {
+    return submit_at(std::chrono::steady_clock::now() + delay, std::forward<F>(f), priority);
+  }
+
+  template<typename F>
+  TimerHandle submit_at(std::chrono::steady_clock::time_point time, F&& f,
+                        Priority priority = Priority::normal);
+
+  template<typename F>
+  TimerHandle submit_every(std::chrono::nanoseconds period, F&& f, Priority priority = Priority::normal);
+
+  // number of armed timers
+  size_t timers() const { return timer_count_.load(std::memory_order_relaxed); }
+
+#ifdef HSTL_COROUTINES
+  // co_await pool.schedule() suspends the coroutine and resumes it on a worker of this pool.
+  // If the pool discards it at shutdown_now(), the coroutine is resumed right there and
+  // co_await throws std::future_error(broken_promise).
+  class ScheduleAwaiter;
+  ScheduleAwaiter schedule(Priority priority = Priority::normal);
+#endif
+
+  // Runs one queued task on the calling thread, returns false if there was none. Lets a thread
+  // waiting for work of this pool (e.g. parallel_for) help instead of blocking a worker.
+  bool run_pending_task();
+
+  // Runs queued tasks on the calling thread until ready() returns true. When there is nothing
+  // to run, the awaited work is running elsewhere: the thread backs off like an idle worker
+  // (IdlePolicy spin and yield rounds), then polls every kHelpSleep.
+  template<typename Ready>
+  void help_until(Ready &&ready);
+
+  // Waits for f, a std::future, std::shared_future or hstl::future. On a worker of this pool
+  // the worker runs queued tasks meanwhile (help_until) instead of blocking, so a task can wait
+  // for tasks it submitted, even on a single worker; the wait may then last as long as the
+  // tasks it picked up. Other threads just block.
+  template<typename Future>
+  void wait(const Future &f);
+  // wait(f), then f.get()
+  template<typename Future>
+  decltype(auto) get(Future &f) {
+    wait(f);
+    return f.get();
+  }
+
+  // number of running workers, changes over time in elastic mode
+  size_t size() const { return active_.load(std::memory_order_relaxed); }
+
+  // Stops accepting new tasks, submit & co. throw from now on. The queued tasks still run and
+  // continuations of their futures are still posted.
+  void close() { closed_.store(true, std::memory_order_seq_cst); }
+  bool is_closed() const { return closed_.load(std::memory_order_acquire); }
+
+  // close(), then with drain wait until every queued task has run (see wait_idle), otherwise
+  // discard the tasks which have not started (their futures get broken_promise). The workers
+  // finish their current task and exit in both cases. Must not be called from a worker.
+  void shutdown(bool drain = true);
+  void shutdown_now() { shutdown(false); }
+
+  // Blocks until every task posted so far, and everything they post, has finished. The pool
+  // stays usable, e.g. between the phases of a batch job. Must not be called from a worker.
+  void wait_idle();
+
+  // number of tasks posted and not finished yet
+  size_t outstanding() const { return outstanding_.load(std::memory_order_acquire); }
+
+  // number of queued tasks in bounded mode (see ThreadPoolOptions::capacity), 0 otherwise
+  size_t queued() const { return queued_.load(std::memory_order_relaxed); }
+
+  // Queue depths, plus the counters and histograms of every worker with
+  // ThreadPoolOptions::collect_stats. Locks the inboxes one after the other, not for the hot path.
+  ThreadPoolStats stats() const;
+
+  // Takes the exceptions of failed tasks kept by ThreadPoolOptions::error_ring_capacity, oldest
+  // first; empty without a ring. Can be called from any thread while the pool runs.
+  std::vector<std::exception_ptr> drain_errors();
+  // errors which found the ring full
+  uint64_t dropped_errors() const { return errors_ ? errors_->dropped() : 0; }
+
+private:
+  // make(i) creates the i-th task node; reserved: the batch already holds its queue slots
+  template<typename MakeTask>
+  void post_batch(size_t count, size_t level, bool reserved, MakeTask &&make);
+  // bounded mode with OverflowPolicy::fail: takes the slots of a whole batch from outside the
+  // pool, false if it does not fit. Sets reserved if it took them.
+  bool admit_batch(size_t count, bool &reserved);
+  // reserved: the task already holds a queue slot of the bounded mode
+  void post(Task *task, Priority priority, bool reserved);
+  // Queues a task of submit, async or try_submit according to the capacity. With ok the task
+  // was queued or has run on the calling thread, otherwise it was discarded.
+  SubmitStatus submit_task(Task *task, Priority priority, OverflowPolicy policy);
+  // takes up to count queue slots for a submission from outside the pool, at least one unless
+  // there is none and policy does not make one; returns the number taken
+  size_t reserve_slots(size_t count, OverflowPolicy policy);
+  // discards the oldest queued task found, whose slot goes to the caller; false if none
+  bool drop_oldest();
+  // count tasks of level which left the queues
+  void took(size_t level, size_t count = 1);
+  void release_slots(size_t count);
+  // wake up to count parked workers
+  void wake(size_t count);
+  void wake_all();
+  // returns true if the worker stayed idle for ElasticPolicy::idle_timeout
+  bool park(size_t id);
+  void discard_all();
+
+  bool is_elastic() const { return options_.elastic.max_threads > 0; }
+  bool is_bounded() const { return options_.capacity > 0; }
+
+  // a constant false when the statistics are compiled out, all recording folds away
+  bool collecting() const { return HSTL_THREAD_POOL_STATS && options_.collect_stats; }
+  WorkerStats *stats_of(size_t id) const { return collecting() ? workers_[id].stats.get() : nullptr; }
+  // start one more worker, returns false if the pool is at its maximum size
+  bool grow();
+  // the worker leaves the pool if it is the last slot and the pool is above its minimum
+  bool try_retire(size_t id);
+  // after a submission: grow if the queues are deep and nobody could be woken
+  void maybe_grow();
+  void monitor_loop();
+
+  friend class TimerHandle;
+  using TimerTick = std::chrono::milliseconds;
+  static constexpr size_t kNoKeeper = static_cast<size_t>(-1);
+  // a busy worker looks at the timers after this many tasks, a spinning one after this many
+  // rounds
+  static constexpr size_t kTimerPollInterval = 64;
+  // polling interval of help_until once the thread has nothing to run
+  static constexpr std::chrono::microseconds kHelpSleep{50};
+
+  uint64_t current_tick() const {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<TimerTick>(std::chrono::steady_clock::now() - epoch_).count());
+  }
+  // the first tick which is not before time
+  uint64_t tick_of(std::chrono::steady_clock::time_point time) const {
+    return time <= epoch_ ? 0 : static_cast<uint64_t>(std::chrono::ceil<TimerTick>(time - epoch_).count());
+  }
+  std::chrono::steady_clock::time_point time_of(uint64_t tick) const {
+    return epoch_ + TimerTick(tick);
+  }
+  TimerHandle arm_timer(std::shared_ptr<timer_detail::TimerEntry> entry, uint64_t deadline);
+  void rearm_timer(std::shared_ptr<timer_detail::TimerEntry> entry);
+  bool cancel_timer(timer_detail::TimerEntry &entry);
+  // makes sure a worker wakes up in time for a timer armed at deadline
+  void timer_armed(uint64_t deadline);
+  // fires the expired timers, if no other thread is doing it
+  void poll_timers();
+  void fire_timer(std::shared_ptr<timer_detail::TimerEntry> entry);
+  void drop_timers();
+
+  // Every worker owns one Chase-Lev deque per priority class: the owner pushes and pops at
+  // the bottom (LIFO), idle workers steal from the top (FIFO). Tasks submitted from outside
+  // the pool land in the inbox of their class first, the owner moves them into its deques
+  // in one batch per lock.
+  struct Level {
+    WorkStealingDeque<Task> deque;
+    RingBuffer<Task*> inbox;    // guarded by Worker::inbox_lock
+  };
+
+  struct alignas(64) Worker {
+    Level levels[kPriorityLevels];
+    mutable std::mutex inbox_lock;
+    size_t bypassed = 0;        // owner only, see ThreadPoolOptions::aging_interval
+    std::atomic<uint64_t> taken{0};  // written by the owner only, read by the elastic monitor
+    std::unique_ptr<WorkerStats> stats;  // null unless collecting()
+    int cpu = -1;               // -1: not pinned
+    // steal victims, constant after construction
+    std::vector<size_t> same_node;
+    std::vector<size_t> other_nodes;
+
+    // parking spot, a waker sets notified and signals only this worker
+    std::mutex park_lock;
+    std::condition_variable park_cv;
+    bool notified = false;      // guarded by park_lock
+    bool timer_kick = false;    // guarded by park_lock, a timer earlier than the keeper's wake-up
+  };
+
+  bool has_pending(std::memory_order order) const {
+    for (auto &p: pending_) {
+      if (p.load(order) > 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // decides the CPU of every worker and the order in which it visits the victims
+  void place_workers() {
+    std::vector<int> nodes(workers_.size(), 0);
+    if (!options_.cpus.empty() || options_.pin_workers) {
+      CpuTopology topology = CpuTopology::detect();
+      const auto &cpus = options_.cpus.empty() ? topology.cpus : options_.cpus;
+      for (size_t i = 0; i < workers_.size(); i++) {
+        workers_[i].cpu = cpus[i % cpus.size()];
+        nodes[i] = topology.node_of(workers_[i].cpu);
+      }
+    }
+    for (size_t i = 0; i < workers_.size(); i++) {
+      for (size_t j = 0; j < workers_.size(); j++) {
+        if (j != i) {
+          (nodes[j] == nodes[i] ? workers_[i].same_node : workers_[i].other_nodes).push_back(j);
+        }
+      }
+    }
+  }
+
+  void worker_loop(size_t id) {
+    if (workers_[id].cpu >= 0) {
+      CpuTopology::pin_current_thread(workers_[id].cpu);
+    }
+    current_pool_ = this;
+    current_id_ = id;
+    uint64_t seed = (id + 1) * 0x9E3779B97F4A7C15ULL;
+    size_t idle_rounds = 0;
+    size_t ran = 0;
+    while (!stop_.load(std::memory_order_acquire)) { // sync point
+      Task *t = get_one_task(id, seed);
+      if (t == nullptr) {
+        poll_timers();
+        // scanning the victims is expensive, in the spin phase only the counters are polled.
+        // Timers are polled too: a worker which never parks (busy_spin) never becomes the
+        // timekeeper, and an expired timer posts its task, which ends the spin
+        while (idle_rounds < options_.idle.spin + options_.idle.yield &&
+               !has_pending(std::memory_order_relaxed) &&
+               !stop_.load(std::memory_order_relaxed)) {
+          if (idle_rounds < options_.idle.spin) {
+            cpu_relax();
+          } else {
+            std::this_thread::yield();
           }
-          
-          try {
-            f();
-          } catch (const std::exception& e) {
-            std::cerr << "Task execution error: " << e.what() << std::endl;
-          } catch (...) {
-            std::cerr << "Unknown error occurred during task execution" << std::endl;
+          if (++idle_rounds % kTimerPollInterval == 0) {
+            poll_timers();
           }
         }
-    });
+        if (idle_rounds >= options_.idle.spin + options_.idle.yield) {
+          if (park(id) && try_retire(id)) {
+            return;
+          }
+          idle_rounds = 0;
+        }
+        continue;
+      }
+      idle_rounds = 0;
+      run_task(t, stats_of(id));
+      if (++ran % kTimerPollInterval == 0) {
+        poll_timers();
+      }
+    }
+  }
+
+  void run_task(Task *t, WorkerStats *stats) {
+    uint64_t start = 0;
+    uint64_t posted = t->stamp();
+    if (stats != nullptr) {
+      start = stats_detail::now_ns();
+    }
+    try {
+      t->run();
+    } catch (...) {
+      task_failed(std::current_exception(), stats);
+    }
+    if (stats != nullptr) {
+      stats->task_run(start > posted ? start - posted : 0, stats_detail::now_ns() - start);
+    }
+    finish_task();
+  }
+
+  // off the hot path: no lock is shared between the workers, a failure storm on some of them
+  // does not slow down the others
+  void task_failed(std::exception_ptr error, WorkerStats *stats) noexcept {
+    if (stats != nullptr) {
+      stats->task_failed();
+    }
+    if (options_.on_error) {
+      try {
+        options_.on_error(error);
+      } catch (...) {
+      }
+    }
+    if (errors_) {
+      errors_->push(std::move(error));
+    }
+  }
+
+  void discard_task(Task *t) {
+    t->discard();
+    finish_task();
+  }
+
+  // outstanding_ and drain_waiters_ form a Dekker pair with wait_idle()
+  void finish_task() {
+    if (outstanding_.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+        drain_waiters_.load(std::memory_order_seq_cst) > 0) {
+      std::unique_lock guard(drain_lock_);
+      drain_cv_.notify_all();
+    }
+  }
+
+  Task *get_one_task(size_t thread_id, uint64_t &seed) {
+    auto &self = workers_[thread_id];
+    bool aging = self.bypassed >= options_.aging_interval;
+    bool drained = false;
+    for (size_t k = 0; k < kPriorityLevels; k++) {
+      size_t level = aging ? kPriorityLevels - 1 - k : k;
+      Task *t = self.levels[level].deque.pop();
+      if (t == nullptr && !drained) {
+        drain_inboxes(self);
+        drained = true;
+        t = self.levels[level].deque.pop();
+      }
+      // a higher class is never left behind for a steal of a lower one
+      if (t == nullptr && pending_[level].load(std::memory_order_relaxed) > 0) {
+        t = steal(thread_id, level, seed);
+        if (WorkerStats *stats = stats_of(thread_id)) {
+          stats->steal_attempt(t != nullptr);
+        }
+      }
+      if (t == nullptr) {
+        continue;
+      }
+      took(level);
+      self.taken.store(self.taken.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      if (aging) {
+        self.bypassed = 0;
+      } else {
+        for (size_t lower = level + 1; lower < kPriorityLevels; lower++) {
+          if (pending_[lower].load(std::memory_order_relaxed) > 0) {
+            self.bypassed++;
+            break;
+          }
+        }
+      }
+      return t;
+    }
+    return nullptr;
+  }
+
+  void drain_inboxes(Worker &self) {
+    std::unique_lock guard(self.inbox_lock);
+    for (auto &level: self.levels) {
+      if (level.inbox.empty()) {
+        continue;
+      }
+      // push in reverse so that the owner pops the inbox in submission order
+      for (size_t i = level.inbox.size(); i-- > 0;) {
+        level.deque.push(level.inbox[i]);
+      }
+      level.inbox.clear();
+    }
+  }
+
+  // for threads outside the pool, which can only steal
+  Task *steal_one(uint64_t &seed) {
+    for (size_t level = 0; level < kPriorityLevels; level++) {
+      if (pending_[level].load(std::memory_order_relaxed) == 0) {
+        continue;
+      }
+      Task *t = steal(workers_.size(), level, seed);
+      if (collecting()) {
+        helper_stats_->steal_attempt(t != nullptr);
+      }
+      if (t != nullptr) {
+        took(level);
+        return t;
+      }
+    }
+    return nullptr;
+  }
+
+  // visit the workers of the same NUMA node, then the others, thread_id is workers_.size()
+  // for threads outside the pool
+  Task *steal(size_t thread_id, size_t level, uint64_t &seed) {
+    if (thread_id == workers_.size()) {
+      return steal_from(workers_.size(), [](size_t k) { return k; }, level, seed);
+    }
+    auto &self = workers_[thread_id];
+    if (Task *t = steal_from(self.same_node.size(), [&self](size_t k) { return self.same_node[k]; },
+                             level, seed)) {
+      return t;
+    }
+    return steal_from(self.other_nodes.size(), [&self](size_t k) { return self.other_nodes[k]; },
+                      level, seed);
+  }
+
+  // visit victim(0) ... victim(n - 1) starting from a random one
+  template<typename Victim>
+  Task *steal_from(size_t n, Victim &&victim_id, size_t level, uint64_t &seed) {
+    if (n == 0) {
+      return nullptr;
+    }
+    // xorshift64
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    size_t start = seed % n;
+    for (size_t k = 0; k < n; k++) {
+      auto &victim = workers_[victim_id((start + k) % n)];
+      if (Task *t = victim.levels[level].deque.steal()) {
+        return t;
+      }
+      // the victim may be busy running a long task while its inbox fills up
+      std::unique_lock guard(victim.inbox_lock);
+      auto &inbox = victim.levels[level].inbox;
+      if (!inbox.empty()) {
+        return inbox.pop_back();
+      }
     }
+    return nullptr;
   }
 
-  ~ThreadPool() {
-    for (auto & q: queues_) {
+  ThreadPoolOptions options_;
+  std::atomic<bool> closed_;   // no new submissions
+  std::atomic<bool> stop_;     // the workers exit
+  // number of tasks submitted but not yet taken by a worker, per priority class
+  std::atomic<size_t> pending_[kPriorityLevels];
+  // number of tasks posted but not finished, for wait_idle()
+  std::atomic<size_t> outstanding_;
+  // bounded mode only: the tasks in the queues, all classes; and the producers waiting for
+  // a slot, a Dekker pair with took()
+  std::atomic<size_t> queued_;
+  std::atomic<size_t> slot_waiters_;
+  std::mutex slot_lock_;
+  std::condition_variable slot_cv_;
+  std::atomic<size_t> sleepers_;
+  // ids of the parked workers, a waker pops exactly the workers it signals
+  std::mutex idle_lock_;
+  std::vector<size_t> idle_;
+  // threads blocked in wait_idle()
+  std::atomic<size_t> drain_waiters_;
+  std::mutex drain_lock_;
+  std::condition_variable drain_cv_;
+  // round-robin cursor for submissions from outside the pool
+  alignas(64) std::atomic<size_t> next_;
+  // workers run on the slots [0, active_), see grow() and try_retire()
+  std::atomic<size_t> active_;
+  std::mutex resize_lock_;
+  std::thread monitor_;
+  std::mutex monitor_lock_;
+  std::condition_variable monitor_cv_;
+  // threads outside the pool running tasks in run_pending_task(), null unless collecting()
+  std::unique_ptr<WorkerStats> helper_stats_;
+  std::unique_ptr<ErrorRing> errors_;
+  // Timers. One parked worker at a time, the timekeeper, sleeps only until the next event of
+  // the wheel (timer_wakeup_); arming an earlier timer kicks it.
+  std::chrono::steady_clock::time_point epoch_;   // tick 0
+  std::mutex timer_lock_;
+  TimerWheel timers_;                             // guarded by timer_lock_
+  std::atomic<size_t> timer_count_;
+  std::atomic<size_t> timekeeper_;                // worker id or kNoKeeper
+  std::atomic<uint64_t> timer_wakeup_;            // tick, TimerWheel::kNever without a keeper
+
+  // set on worker threads, so that a task submitting more tasks to its own pool
+  // pushes into its own deque instead of going through an inbox
+  static inline thread_local ThreadPool *current_pool_ = nullptr;
+  static inline thread_local size_t current_id_ = 0;
+  // victim selection of run_pending_task
+  static inline thread_local uint64_t helper_seed_ = 0x9E3779B97F4A7C15ULL;
+
+  std::vector<Worker> workers_;
+  std::vector<std::thread> threads_;
+};
+
+template<typename F, typename... Args, typename R>
+auto ThreadPool::submit(Priority priority, F&& f, Args&&... args) -> std::future<R> {
+  if (closed_.load(std::memory_order_acquire)) {
+    throw std::runtime_error("Cannot submit task to closed ThreadPool");
+  }
+
+  // the shared state of the future comes from the pool too
+  std::promise<R> promise(std::allocator_arg, pool_allocator<char>());
+  auto future = promise.get_future();
+
+  Task *task = Task::create([promise = std::move(promise), func = std::forward<F>(f),
+                             args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+    try {
+      if constexpr (std::is_void_v<R>) {
+        std::apply(std::move(func), std::move(args));
+        promise.set_value();
+      } else {
+        promise.set_value(std::apply(std::move(func), std::move(args)));
+      }
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+    }
+  });
+  if (submit_task(task, priority, options_.overflow) != SubmitStatus::ok) {
+    throw std::runtime_error("Cannot submit task to full ThreadPool");
+  }
+  return future;
+}
+
+template<typename F, typename... Args, typename R>
+auto ThreadPool::try_submit(Priority priority, F&& f, Args&&... args) -> std::pair<SubmitStatus, std::future<R>> {
+  if (closed_.load(std::memory_order_acquire)) {
+    return {SubmitStatus::closed, std::future<R>()};
+  }
+
+  std::promise<R> promise(std::allocator_arg, pool_allocator<char>());
+  auto future = promise.get_future();
+  Task *task = Task::create([promise = std::move(promise), func = std::forward<F>(f),
+                             args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+    try {
+      if constexpr (std::is_void_v<R>) {
+        std::apply(std::move(func), std::move(args));
+        promise.set_value();
+      } else {
+        promise.set_value(std::apply(std::move(func), std::move(args)));
+      }
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+    }
+  });
+  SubmitStatus status = submit_task(task, priority, OverflowPolicy::fail);
+  if (status != SubmitStatus::ok) {
+    return {status, std::future<R>()};
+  }
+  return {status, std::move(future)};
+}
+
+template<typename F, typename... Args, typename R>
+auto ThreadPool::async(Priority priority, F&& f, Args&&... args) -> future<R> {
+  if (closed_.load(std::memory_order_acquire)) {
+    throw std::runtime_error("Cannot submit task to closed ThreadPool");
+  }
+
+  promise<R> p(this);
+  auto result = p.get_future();
+  Task *task = Task::create([p = std::move(p), func = std::forward<F>(f),
+                             args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+    p.set_from([&]() -> R { return std::apply(std::move(func), std::move(args)); });
+  });
+  if (submit_task(task, priority, options_.overflow) != SubmitStatus::ok) {
+    throw std::runtime_error("Cannot submit task to full ThreadPool");
+  }
+  return result;
+}
+
+template<typename F>
+future<void> ThreadPool::submit_n(size_t count, F&& f, Priority priority) {
+  if (closed_.load(std::memory_order_acquire)) {
+    throw std::runtime_error("Cannot submit task to closed ThreadPool");
+  }
+  if (count == 0) {
+    return make_ready_future();
+  }
+
+  bool reserved = false;
+  if (!admit_batch(count, reserved)) {
+    throw std::runtime_error("Cannot submit task to full ThreadPool");
+  }
+
+  using Func = std::decay_t<F>;
+  auto state = BatchState<Func>::create(this, count, Func(std::forward<F>(f)));
+  auto result = state->get_future();
+  post_batch(count, static_cast<size_t>(priority), reserved,
+             [state](size_t i) { return Task::create(BatchTask<Func>(state, i)); });
+  return result;
+}
+
+template<typename ForwardIt>
+future<void> ThreadPool::submit_batch(ForwardIt first, ForwardIt last, Priority priority) {
+  static_assert(std::is_base_of_v<std::forward_iterator_tag,
+                                  typename std::iterator_traits<ForwardIt>::iterator_category>,
+                "submit_batch needs a forward iterator");
+  if (closed_.load(std::memory_order_acquire)) {
+    throw std::runtime_error("Cannot submit task to closed ThreadPool");
+  }
+  size_t count = std::distance(first, last);
+  if (count == 0) {
+    return make_ready_future();
+  }
+  bool reserved = false;
+  if (!admit_batch(count, reserved)) {
+    throw std::runtime_error("Cannot submit task to full ThreadPool");
+  }
+
+  using Callable = std::decay_t<decltype(*first)>;
+  auto state = BatchState<batch_no_func>::create(this, count, batch_no_func());
+  auto result = state->get_future();
+  // post_batch asks for the tasks in order
+  post_batch(count, static_cast<size_t>(priority), reserved, [state, &first](size_t) {
+    Task *t = Task::create(BatchTask<batch_no_func, Callable>(state, std::move(*first)));
+    ++first;
+    return t;
+  });
+  return result;
+}
+
+template<typename F>
+TimerHandle ThreadPool::submit_at(std::chrono::steady_clock::time_point time, F&& f, Priority priority) {
+  if (closed_.load(std::memory_order_acquire)) {
+    throw std::runtime_error("Cannot submit task to closed ThreadPool");
+  }
+  auto entry = std::make_shared<timer_detail::TimerEntry>();
+  entry->priority = priority;
+  entry->task = Task::create(std::forward<F>(f));
+  return arm_timer(std::move(entry), tick_of(time));
+}
+
+template<typename F>
+TimerHandle ThreadPool::submit_every(std::chrono::nanoseconds period, F&& f, Priority priority) {
+  if (closed_.load(std::memory_order_acquire)) {
+    throw std::runtime_error("Cannot submit task to closed ThreadPool");
+  }
+  using Func = std::decay_t<F>;
+  auto entry = std::make_shared<timer_detail::PeriodicTimer<Func>>(Func(std::forward<F>(f)));
+  entry->priority = priority;
+  entry->period = static_cast<uint64_t>(std::max<TimerTick::rep>(1, std::chrono::ceil<TimerTick>(period).count()));
+  uint64_t deadline = current_tick() + entry->period;
+  return arm_timer(std::move(entry), deadline);
+}
+
+template<typename MakeTask>
+void ThreadPool::post_batch(size_t count, size_t level, bool reserved, MakeTask &&make) {
+  outstanding_.fetch_add(count, std::memory_order_relaxed);
+  // the workers are never held back, a batch from outside the pool takes its slots chunk by
+  // chunk unless admit_batch() has taken them all
+  bool held_back = is_bounded() && current_pool_ != this && !reserved;
+  if (is_bounded() && current_pool_ == this) {
+    queued_.fetch_add(count, std::memory_order_relaxed);
+  }
+  size_t posted = 0;
+  size_t woken = 0;
+  if (current_pool_ == this) {
+    // owner thread, everything goes into its own deque and idle workers steal from there
+    auto &deque = workers_[current_id_].levels[level].deque;
+    for (size_t i = 0; i < count; i++) {
+      Task *t = make(i);
+      if (collecting()) {
+        t->set_stamp(stats_detail::now_ns());
+      }
+      pending_[level].fetch_add(1, std::memory_order_relaxed);
+      deque.push(t);
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    posted = count;
+  } else {
+    // split into one chunk per worker, every inbox is locked once
+    static thread_local std::vector<Task*> chunk;
+    size_t n = size();
+    size_t start = next_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t now = collecting() ? stats_detail::now_ns() : 0;
+    for (size_t k = 0; posted < count; k++) {
+      size_t workers_left = k < n ? n - k : 1;
+      size_t len = (count - posted + workers_left - 1) / workers_left;
+      if (held_back) {
+        // the queued chunks must run for slots to free up
+        wake(posted - woken);
+        woken = posted;
+        // blocks, or drops the oldest tasks, until at least one slot is free
+        len = reserve_slots(len, options_.overflow);
+        if (len == 0) {
+          // caller_runs: the rest of the batch runs here, which slows the producer down
+          for (size_t i = posted; i < count; i++) {
+            make(i)->run();
+            finish_task();
+          }
+          break;
+        }
+      }
+      chunk.clear();
+      for (size_t i = posted; i < posted + len; i++) {
+        chunk.push_back(make(i));
+        chunk.back()->set_stamp(now);
+      }
+      pending_[level].fetch_add(len, std::memory_order_seq_cst);
+      auto &w = workers_[(start + k) % n];
+      bool stopped;
       {
-        std::unique_lock<std::mutex> guard(q.lock);
-        closed_.store(true, std::memory_order_release); // sync point
+        std::unique_lock guard(w.inbox_lock);
+        // see post()
+        stopped = stop_.load(std::memory_order_acquire);
+        if (!stopped) {
+          for (Task *t: chunk) {
+            w.levels[level].inbox.push_back(t);
+          }
+        }
+      }
+      if (stopped) {
+        took(level, len);
+        for (Task *t: chunk) {
+          discard_task(t);
+        }
+      }
+      posted += len;
+    }
+    chunk.clear();
+  }
+  wake(posted - woken);
+  if (is_elastic()) {
+    maybe_grow();
+  }
+}
+
+inline bool ThreadPool::admit_batch(size_t count, bool &reserved) {
+  if (!is_bounded() || current_pool_ == this || options_.overflow != OverflowPolicy::fail) {
+    return true;
+  }
+  size_t queued = queued_.load(std::memory_order_relaxed);
+  do {
+    if (count > options_.capacity || queued > options_.capacity - count) {
+      return false;
+    }
+  } while (!queued_.compare_exchange_weak(queued, queued + count, std::memory_order_relaxed));
+  reserved = true;
+  return true;
+}
+
+inline void ThreadPool::post(Task *task, Priority priority) {
+  post(task, priority, false);
+}
+
+inline void ThreadPool::post(Task *task, Priority priority, bool reserved) {
+  outstanding_.fetch_add(1, std::memory_order_relaxed);
+  if (stop_.load(std::memory_order_acquire)) {
+    // e.g. a continuation of a future completed by shutdown_now()
+    if (reserved) {
+      release_slots(1);
+    }
+    discard_task(task);
+    return;
+  }
+  if (is_bounded() && !reserved) {
+    queued_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (collecting()) {
+    task->set_stamp(stats_detail::now_ns());
+  }
+  size_t level = static_cast<size_t>(priority);
+  pending_[level].fetch_add(1, std::memory_order_seq_cst);
+  if (current_pool_ == this) {
+    // owner thread, no lock at all
+    workers_[current_id_].levels[level].deque.push(task);
+  } else {
+    // a worker retiring right now leaves its inbox to the thieves
+    auto &w = workers_[next_.fetch_add(1, std::memory_order_relaxed) % size()];
+    std::unique_lock guard(w.inbox_lock);
+    // shutdown raced with us, discard_all() drains the inboxes under this lock after stop_
+    if (stop_.load(std::memory_order_acquire)) {
+      guard.unlock();
+      took(level);
+      discard_task(task);
+      return;
+    }
+    w.levels[level].inbox.push_back(task);
+  }
+  wake(1);
+  if (is_elastic()) {
+    maybe_grow();
+  }
+}
+
+inline SubmitStatus ThreadPool::submit_task(Task *task, Priority priority, OverflowPolicy policy) {
+  // the workers are never held back
+  if (!is_bounded() || current_pool_ == this) {
+    post(task, priority, false);
+    return SubmitStatus::ok;
+  }
+  if (reserve_slots(1, policy) > 0) {
+    post(task, priority, true);
+    return SubmitStatus::ok;
+  }
+  if (policy == OverflowPolicy::caller_runs) {
+    // the callables of submit and async keep their exceptions in the future
+    task->run();
+    return SubmitStatus::ok;
+  }
+  task->discard();
+  return SubmitStatus::full;
+}
+
+inline size_t ThreadPool::reserve_slots(size_t count, OverflowPolicy policy) {
+  size_t queued = queued_.load(std::memory_order_relaxed);
+  for (;;) {
+    if (queued < options_.capacity) {
+      size_t n = std::min(count, options_.capacity - queued);
+      if (queued_.compare_exchange_weak(queued, queued + n, std::memory_order_relaxed)) {
+        return n;
+      }
+      continue;
+    }
+    switch (policy) {
+      case OverflowPolicy::fail:
+      case OverflowPolicy::caller_runs:
+        return 0;
+      case OverflowPolicy::drop_oldest:
+        if (drop_oldest()) {
+          return 1;
+        }
+        break;
+      case OverflowPolicy::block: {
+        slot_waiters_.fetch_add(1, std::memory_order_seq_cst);
+        {
+          std::unique_lock guard(slot_lock_);
+          slot_cv_.wait(guard, [this]() {
+            return queued_.load(std::memory_order_seq_cst) < options_.capacity;
+          });
+        }
+        slot_waiters_.fetch_sub(1, std::memory_order_relaxed);
+        break;
+      }
+    }
+    queued = queued_.load(std::memory_order_relaxed);
+  }
+}
+
+inline bool ThreadPool::drop_oldest() {
+  // lowest class first; in a deque the top is the oldest task, and a worker's inbox is younger
+  // than its deque
+  size_t n = workers_.size();
+  size_t start = next_.load(std::memory_order_relaxed);
+  for (size_t k = kPriorityLevels; k-- > 0;) {
+    if (pending_[k].load(std::memory_order_relaxed) == 0) {
+      continue;
+    }
+    for (size_t i = 0; i < n; i++) {
+      auto &w = workers_[(start + i) % n];
+      Task *t = w.levels[k].deque.steal();
+      if (t == nullptr) {
+        std::unique_lock guard(w.inbox_lock);
+        if (!w.levels[k].inbox.empty()) {
+          t = w.levels[k].inbox.pop_front();
+        }
+      }
+      if (t != nullptr) {
+        pending_[k].fetch_sub(1, std::memory_order_relaxed);
+        discard_task(t);
+        return true;
       }
-      q.cv.notify_all();
     }
-    
-    for (auto & t: threads_) {
+  }
+  return false;
+}
+
+inline void ThreadPool::took(size_t level, size_t count) {
+  pending_[level].fetch_sub(count, std::memory_order_relaxed);
+  if (is_bounded()) {
+    release_slots(count);
+  }
+}
+
+// queued_ and slot_waiters_ form a Dekker pair with reserve_slots()
+inline void ThreadPool::release_slots(size_t count) {
+  size_t left = queued_.fetch_sub(count, std::memory_order_seq_cst) - count;
+  // blocked producers are woken once a quarter of the capacity is free, not for every task;
+  // a waiter which finds any free slot does not sleep, so the crossing release sees it
+  size_t low_water = options_.capacity - std::max<size_t>(1, options_.capacity / 4);
+  if (left <= low_water && slot_waiters_.load(std::memory_order_seq_cst) > 0) {
+    std::unique_lock guard(slot_lock_);
+    slot_cv_.notify_all();
+  }
+}
+
+namespace wait_detail {
+
+template<typename T>
+bool is_ready(const std::future<T> &f) {
+  return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+template<typename T>
+bool is_ready(const std::shared_future<T> &f) {
+  return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+template<typename T>
+bool is_ready(const future<T> &f) {
+  return f.is_ready();
+}
+
+}
+
+template<typename Ready>
+void ThreadPool::help_until(Ready &&ready) {
+  size_t idle_rounds = 0;
+  const size_t backoff = options_.idle.spin + options_.idle.yield;
+  while (!ready()) {
+    if (run_pending_task()) {
+      idle_rounds = 0;
+      continue;
+    }
+    if (idle_rounds < options_.idle.spin) {
+      cpu_relax();
+    } else if (idle_rounds < backoff) {
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(kHelpSleep);
+    }
+    if (idle_rounds < backoff) {
+      idle_rounds++;
+    }
+  }
+}
+
+template<typename Future>
+void ThreadPool::wait(const Future &f) {
+  if (current_pool_ != this) {
+    f.wait();
+    return;
+  }
+  help_until([&f]() { return wait_detail::is_ready(f); });
+}
+
+inline bool ThreadPool::run_pending_task() {
+  bool own = current_pool_ == this;
+  Task *t = own ? get_one_task(current_id_, helper_seed_) : steal_one(helper_seed_);
+  if (t == nullptr) {
+    return false;
+  }
+  run_task(t, own ? stats_of(current_id_) : (collecting() ? helper_stats_.get() : nullptr));
+  return true;
+}
+
+inline void ThreadPool::shutdown(bool drain) {
+  if (current_pool_ == this) {
+    throw std::logic_error("ThreadPool::shutdown() called from one of its workers");
+  }
+  close();
+  if (drain) {
+    wait_idle();
+  }
+  stop_.store(true, std::memory_order_seq_cst); // sync point
+  if (monitor_.joinable()) {
+    { std::unique_lock guard(monitor_lock_); }
+    monitor_cv_.notify_all();
+    monitor_.join();
+  }
+  wake_all();
+  {
+    // no worker is started once stop_ is set
+    std::unique_lock guard(resize_lock_);
+    for (auto &t: threads_) {
       if (t.joinable()) {
         t.join();
       }
     }
   }
+  discard_all();
+  drop_timers();
+}
 
-  template<typename F, typename... Args, typename R = std::invoke_result_t<F, Args...>>
-  auto submit(F&& f, Args&&... args) -> std::future<R>;
-  
-  bool is_closed() const { return closed_.load(std::memory_order_acquire); }
-  void close() {
-    for (auto &queue: queues_) {
-      std::unique_lock<std::mutex> guard(queue.lock);
-      closed_.store(true, std::memory_order_release); // sync point
-    }
+inline void ThreadPool::wait_idle() {
+  if (current_pool_ == this) {
+    throw std::logic_error("ThreadPool::wait_idle() called from one of its workers");
   }
+  if (outstanding_.load(std::memory_order_acquire) == 0) {
+    return;
+  }
+  drain_waiters_.fetch_add(1, std::memory_order_seq_cst);
+  {
+    std::unique_lock guard(drain_lock_);
+    drain_cv_.wait(guard, [this]() { return outstanding_.load(std::memory_order_seq_cst) == 0; });
+  }
+  drain_waiters_.fetch_sub(1, std::memory_order_relaxed);
+}
 
-private:
-  std::atomic<bool> closed_;
+inline std::vector<std::exception_ptr> ThreadPool::drain_errors() {
+  std::vector<std::exception_ptr> errors;
+  std::exception_ptr error;
+  while (errors_ && errors_->pop(error)) {
+    errors.push_back(std::move(error));
+  }
+  return errors;
+}
 
-  Task get_one_task(int thread_id) {
-    auto &t = threads_[thread_id];
-    auto &queue = queues_[thread_id];
-    Task f = nullptr;
+inline ThreadPoolStats ThreadPool::stats() const {
+  ThreadPoolStats s;
+  s.workers.resize(workers_.size());
+  for (size_t i = 0; i < workers_.size(); i++) {
+    auto &w = workers_[i];
+    if (w.stats) {
+      s.workers[i] = w.stats->snapshot();
+    }
+    size_t depth = 0;
+    for (auto &level: w.levels) {
+      depth += level.deque.size();
+    }
     {
-      std::unique_lock guard(queue.lock);
-      if (!queue.q.empty()) {
-        f = std::move(queue.q.front());
-        queue.q.pop();
-        return f;
+      std::unique_lock guard(w.inbox_lock);
+      for (auto &level: w.levels) {
+        depth += level.inbox.size();
       }
     }
+    s.workers[i].queue_depth = depth;
+  }
+  if (helper_stats_) {
+    s.helpers = helper_stats_->snapshot();
+  }
+  s.threads = size();
+  for (auto &p: pending_) {
+    s.pending += p.load(std::memory_order_relaxed);
+  }
+  s.outstanding = outstanding();
+  return s;
+}
 
-    for (int i = 0; i < threads_.size(); i++) {
-      if (i == thread_id) {
-        continue;
+// only after the workers have exited
+inline void ThreadPool::discard_all() {
+  std::vector<Task*> tasks;
+  for (auto &w: workers_) {
+    for (size_t level = 0; level < kPriorityLevels; level++) {
+      while (Task *t = w.levels[level].deque.pop()) {
+        tasks.push_back(t);
       }
-      
       {
-        std::unique_lock guard(queue.lock);
-        if (!queue.q.empty()) {
-          f = std::move(queue.q.front());
-          queue.q.pop();
-          break;
+        // threads outside the pool may still be posting, see post()
+        std::unique_lock guard(w.inbox_lock);
+        auto &inbox = w.levels[level].inbox;
+        for (size_t i = 0; i < inbox.size(); i++) {
+          tasks.push_back(inbox[i]);
         }
+        inbox.clear();
+      }
+      took(level, tasks.size());
+      // discarding may complete futures whose continuations are posted, and discarded, now
+      for (Task *t: tasks) {
+        discard_task(t);
       }
+      tasks.clear();
     }
+  }
+}
 
-    return f;
+inline void ThreadPool::wake_all() {
+  for (auto &w: workers_) {
+    {
+      std::unique_lock guard(w.park_lock);
+      w.notified = true;
+    }
+    w.park_cv.notify_one();
+  }
+}
+
+// pending_ and sleepers_ form a Dekker pair with park(): either the submitter sees the
+// parked worker in idle_ and signals it, or the worker sees the task and does not sleep.
+inline void ThreadPool::wake(size_t count) {
+  if (sleepers_.load(std::memory_order_seq_cst) == 0) {
+    return;
+  }
+  // signal outside of idle_lock_, in rounds of up to 64 workers
+  size_t woken[64];
+  while (count > 0) {
+    size_t n = 0;
+    {
+      std::unique_lock guard(idle_lock_);
+      while (n < count && n < 64 && !idle_.empty()) {
+        woken[n++] = idle_.back();
+        idle_.pop_back();
+      }
+      sleepers_.fetch_sub(n, std::memory_order_relaxed);
+    }
+    if (n == 0) {
+      return;
+    }
+    for (size_t i = 0; i < n; i++) {
+      auto &w = workers_[woken[i]];
+      {
+        std::unique_lock guard(w.park_lock);
+        w.notified = true;
+      }
+      w.park_cv.notify_one();
+    }
+    count -= n;
+  }
+}
+
+inline bool ThreadPool::park(size_t id) {
+  {
+    std::unique_lock guard(idle_lock_);
+    idle_.push_back(id);
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+  }
+  if (has_pending(std::memory_order_seq_cst) || stop_.load(std::memory_order_seq_cst)) {
+    std::unique_lock guard(idle_lock_);
+    auto it = std::find(idle_.begin(), idle_.end(), id);
+    if (it != idle_.end()) {
+      idle_.erase(it);
+      sleepers_.fetch_sub(1, std::memory_order_relaxed);
+      return false;
+    }
+    // a waker has already taken us out of idle_, consume its notification below
+  }
+  WorkerStats *stats = stats_of(id);
+  uint64_t parked_at = stats != nullptr ? stats_detail::now_ns() : 0;
+
+  // timer_count_ and sleepers_ form a Dekker pair with timer_armed(): either a timer armed
+  // now sees this worker in idle_ and wakes it, or this worker sees the timer
+  auto until = std::chrono::steady_clock::time_point::max();
+  auto idle_deadline = until;
+  if (is_elastic()) {
+    idle_deadline = std::chrono::steady_clock::now() + options_.elastic.idle_timeout;
+    until = idle_deadline;
+  }
+  size_t no_keeper = kNoKeeper;
+  bool keeper = timer_count_.load(std::memory_order_seq_cst) > 0 &&
+                timekeeper_.compare_exchange_strong(no_keeper, id, std::memory_order_seq_cst);
+  if (keeper) {
+    uint64_t wakeup;
+    {
+      std::unique_lock guard(timer_lock_);
+      wakeup = timers_.next_event();
+    }
+    timer_wakeup_.store(wakeup, std::memory_order_seq_cst);
+    if (wakeup != TimerWheel::kNever) {
+      until = std::min(until, time_of(wakeup));
+    }
   }
-  
-  struct cv_queue {
-    std::mutex lock;
-    std::condition_variable cv;
 
-    std::queue<Task> q;
+  auto &w = workers_[id];
+  std::unique_lock guard(w.park_lock);
+  auto woken = [this, &w]() {
+    return w.notified || w.timer_kick || stop_.load(std::memory_order_relaxed);
   };
+  if (until == std::chrono::steady_clock::time_point::max()) {
+    w.park_cv.wait(guard, woken);
+  } else {
+    w.park_cv.wait_until(guard, until, woken);
+  }
+  w.timer_kick = false;
+  if (keeper) {
+    timer_wakeup_.store(TimerWheel::kNever, std::memory_order_seq_cst);
+    timekeeper_.store(kNoKeeper, std::memory_order_seq_cst);
+  }
+  bool retire = false;
+  if (!w.notified && !stop_.load(std::memory_order_relaxed)) {
+    // timed out or kicked, still in idle_ unless a waker has popped us just now
+    guard.unlock();
+    bool popped = true;
+    {
+      std::unique_lock idle_guard(idle_lock_);
+      auto it = std::find(idle_.begin(), idle_.end(), id);
+      if (it != idle_.end()) {
+        idle_.erase(it);
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        popped = false;
+        retire = !keeper && std::chrono::steady_clock::now() >= idle_deadline;
+      }
+    }
+    guard.lock();
+    if (popped) {
+      // its notification is on the way
+      w.park_cv.wait(guard, [this, &w]() { return w.notified || stop_.load(std::memory_order_relaxed); });
+    }
+  }
+  w.notified = false;
+  if (stats != nullptr) {
+    stats->parked(stats_detail::now_ns() - parked_at);
+  }
+  return retire;
+}
 
-  std::vector<cv_queue> queues_;
-  std::vector<std::thread> threads_;
-};
+inline TimerHandle ThreadPool::arm_timer(std::shared_ptr<timer_detail::TimerEntry> entry,
+                                          uint64_t deadline) {
+  std::weak_ptr<timer_detail::TimerEntry> handle = entry;
+  {
+    std::unique_lock guard(timer_lock_);
+    if (!stop_.load(std::memory_order_acquire)) {
+      entry->deadline = deadline;
+      timers_.insert(entry.get());
+      deadline = entry->deadline;
+      entry->self = std::move(entry);
+      timer_count_.fetch_add(1, std::memory_order_seq_cst);
+    }
+  }
+  if (entry) {
+    // the pool is gone already
+    if (entry->task != nullptr) {
+      entry->task->discard();
+    }
+    return TimerHandle();
+  }
+  timer_armed(deadline);
+  return TimerHandle(this, std::move(handle));
+}
 
-template<typename F, typename... Args, typename R>
-auto ThreadPool::submit(F&& f, Args&&... args) -> std::future<R> {
-  auto func = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
-  auto p = std::make_shared<std::packaged_task<R()>>(func);
-  auto future = p->get_future();
+// periodic timers, after a run: the next deadline on the grid of the period after now
+inline void ThreadPool::rearm_timer(std::shared_ptr<timer_detail::TimerEntry> entry) {
+  uint64_t deadline;
+  {
+    std::unique_lock guard(timer_lock_);
+    if (entry->cancelled || stop_.load(std::memory_order_acquire)) {
+      return;
+    }
+    uint64_t now = current_tick();
+    deadline = entry->deadline + entry->period;
+    if (deadline <= now) {
+      deadline += (now - deadline) / entry->period * entry->period + entry->period;
+    }
+    entry->deadline = deadline;
+    timers_.insert(entry.get());
+    deadline = entry->deadline;
+    entry->self = std::move(entry);
+    timer_count_.fetch_add(1, std::memory_order_seq_cst);
+  }
+  timer_armed(deadline);
+}
 
-  if (closed_.load(std::memory_order_acquire)) {
-    throw std::runtime_error("Cannot submit task to closed ThreadPool");
+inline bool ThreadPool::cancel_timer(timer_detail::TimerEntry &entry) {
+  Task *task = nullptr;
+  bool armed;
+  {
+    std::unique_lock guard(timer_lock_);
+    armed = !entry.cancelled && (entry.period > 0 || entry.linked());
+    entry.cancelled = true;
+    if (entry.linked()) {
+      timers_.erase(&entry);
+      timer_count_.fetch_sub(1, std::memory_order_relaxed);
+      task = std::exchange(entry.task, nullptr);
+      entry.self.reset();  // the caller holds another reference
+    }
+  }
+  if (task != nullptr) {
+    task->discard();
+  }
+  return armed;
+}
+
+inline void ThreadPool::timer_armed(uint64_t deadline) {
+  size_t keeper = timekeeper_.load(std::memory_order_seq_cst);
+  if (keeper == kNoKeeper) {
+    wake(1);
+    return;
+  }
+  if (deadline < timer_wakeup_.load(std::memory_order_seq_cst)) {
+    auto &w = workers_[keeper];
+    {
+      std::unique_lock guard(w.park_lock);
+      w.timer_kick = true;
+    }
+    w.park_cv.notify_one();
   }
+}
 
-  static std::mutex i_lock;
-  static int i = 0;
-  
-  i_lock.lock();
-  auto &queue = queues_[i];
-  i = (i + 1) % queues_.size();
-  i_lock.unlock();
+inline void ThreadPool::poll_timers() {
+  if (timer_count_.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+  static thread_local std::vector<std::shared_ptr<timer_detail::TimerEntry>> expired;
   {
-    std::unique_lock guard(queue.lock);
-    queue.q.push([=]() { (*p)(); });
+    std::unique_lock guard(timer_lock_, std::try_to_lock);
+    if (!guard) {
+      return;
+    }
+    timers_.advance(current_tick(), [](TimerWheelNode *node) {
+      expired.push_back(std::move(static_cast<timer_detail::TimerEntry *>(node)->self));
+    });
+    timer_count_.fetch_sub(expired.size(), std::memory_order_relaxed);
+  }
+  for (auto &entry: expired) {
+    fire_timer(std::move(entry));
   }
+  expired.clear();
+}
 
-  queue.cv.notify_one();
-  return future;
+inline void ThreadPool::fire_timer(std::shared_ptr<timer_detail::TimerEntry> entry) {
+  if (entry->period == 0) {
+    post(std::exchange(entry->task, nullptr), entry->priority);
+    return;
+  }
+  Priority priority = entry->priority;
+  post(Task::create([this, entry = std::move(entry)]() mutable {
+    struct Rearm {
+      ThreadPool *pool;
+      std::shared_ptr<timer_detail::TimerEntry> &entry;
+      ~Rearm() { pool->rearm_timer(std::move(entry)); }
+    } rearm{this, entry};
+    entry->run(*entry);
+  }), priority);
+}
+
+// only after the workers have exited
+inline void ThreadPool::drop_timers() {
+  std::vector<std::shared_ptr<timer_detail::TimerEntry>> dropped;
+  {
+    std::unique_lock guard(timer_lock_);
+    timers_.clear([&dropped](TimerWheelNode *node) {
+      dropped.push_back(std::move(static_cast<timer_detail::TimerEntry *>(node)->self));
+    });
+    timer_count_.store(0, std::memory_order_relaxed);
+  }
+  for (auto &entry: dropped) {
+    if (entry->task != nullptr) {
+      std::exchange(entry->task, nullptr)->discard();
+    }
+  }
+}
+
+#ifdef HSTL_COROUTINES
+class ThreadPool::ScheduleAwaiter {
+public:
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> coroutine) {
+    Resume resume{coroutine, &discarded_};
+    Task *task;
+    try {
+      task = Task::create(std::move(resume));
+    } catch (...) {
+      // co_await rethrows, the coroutine must not be resumed twice
+      resume.coroutine = nullptr;
+      throw;
+    }
+    pool_->post(task, priority_);
+  }
+
+  void await_resume() const {
+    if (discarded_) {
+      throw std::future_error(std::future_errc::broken_promise);
+    }
+  }
+
+private:
+  friend class ThreadPool;
+  ScheduleAwaiter(ThreadPool *pool, Priority priority) : pool_(pool), priority_(priority) {}
+
+  // resumes the coroutine when run, and when discarded too (with discarded set)
+  struct Resume {
+    std::coroutine_handle<> coroutine;
+    bool *discarded;
+
+    Resume(std::coroutine_handle<> c, bool *d) : coroutine(c), discarded(d) {}
+    Resume(Resume &&other) noexcept
+    : coroutine(std::exchange(other.coroutine, nullptr)), discarded(other.discarded) {}
+    ~Resume() {
+      if (coroutine) {
+        *discarded = true;
+        std::exchange(coroutine, nullptr).resume();
+      }
+    }
+    void operator()() { std::exchange(coroutine, nullptr).resume(); }
+  };
+
+  ThreadPool *pool_;
+  Priority priority_;
+  bool discarded_ = false;
+};
+
+inline ThreadPool::ScheduleAwaiter ThreadPool::schedule(Priority priority) {
+  return ScheduleAwaiter(this, priority);
+}
+#endif
+
+inline bool TimerHandle::cancel() {
+  auto entry = entry_.lock();
+  return entry != nullptr && pool_->cancel_timer(*entry);
+}
+
+inline bool ThreadPool::grow() {
+  std::unique_lock guard(resize_lock_);
+  size_t id = active_.load(std::memory_order_relaxed);
+  if (stop_.load(std::memory_order_acquire) || id >= workers_.size()) {
+    return false;
+  }
+  // a retired worker of this slot has already left worker_loop
+  if (threads_[id].joinable()) {
+    threads_[id].join();
+  }
+  threads_[id] = std::thread([this, id]() { worker_loop(id); });
+  active_.store(id + 1, std::memory_order_relaxed);
+  return true;
+}
+
+inline bool ThreadPool::try_retire(size_t id) {
+  std::unique_lock guard(resize_lock_);
+  size_t active = active_.load(std::memory_order_relaxed);
+  if (stop_.load(std::memory_order_acquire) || id + 1 != active ||
+      active <= std::max<size_t>(options_.elastic.min_threads, 1)) {
+    return false;
+  }
+  active_.store(active - 1, std::memory_order_relaxed);
+  return true;
+}
+
+inline void ThreadPool::maybe_grow() {
+  size_t active = active_.load(std::memory_order_relaxed);
+  if (active >= workers_.size() || sleepers_.load(std::memory_order_relaxed) > 0) {
+    return;
+  }
+  size_t queued = 0;
+  for (auto &p: pending_) {
+    queued += p.load(std::memory_order_relaxed);
+  }
+  if (queued > active * options_.elastic.queue_depth) {
+    grow();
+  }
+}
+
+// Stall detection: if tasks are waiting and no worker has taken one for a whole
+// stall_timeout, the workers are busy with long or blocking tasks and one more is started.
+inline void ThreadPool::monitor_loop() {
+  uint64_t last = 0;
+  std::unique_lock guard(monitor_lock_);
+  while (!monitor_cv_.wait_for(guard, options_.elastic.stall_timeout,
+                               [this]() { return stop_.load(std::memory_order_relaxed); })) {
+    uint64_t taken = 0;
+    for (auto &w: workers_) {
+      taken += w.taken.load(std::memory_order_relaxed);
+    }
+    if (taken == last && has_pending(std::memory_order_relaxed)) {
+      grow();
+    }
+    last = taken;
+  }
 }
 
 }
 
-#endif // THREAD_POOL_H_
\ No newline at end of file
+#endif // THREAD_POOL_H_
@@ -0,0 +1,256 @@
+#ifndef THREAD_POOL_STATS_HPP_
+#define THREAD_POOL_STATS_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Define as 0 to compile the ThreadPool statistics out entirely; ThreadPoolOptions::collect_stats
+// is then ignored and ThreadPool::stats() only reports the queue depths.
+#ifndef HSTL_THREAD_POOL_STATS
+#define HSTL_THREAD_POOL_STATS 1
+#endif
+
+namespace hstl {
+
+namespace stats_detail {
+
+inline uint64_t now_ns() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// index of the highest set bit, v > 0
+inline size_t log2(uint64_t v) {
+#if defined(__GNUC__)
+  return 63 - static_cast<size_t>(__builtin_clzll(v));
+#else
+  size_t r = 0;
+  while (v >>= 1) {
+    r++;
+  }
+  return r;
+#endif
+}
+
+// Relaxed counter. A single writer adds with a plain load and store, no locked instruction on
+// the hot path; counters written by several threads use add_shared().
+class Counter {
+ public:
+  void add(uint64_t n = 1) {
+    value_.store(value_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+  void add_shared(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+  uint64_t load() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint64_t> value_{0};
+};
+
+}  // namespace stats_detail
+
+// A copy of a LatencyHistogram, values in nanoseconds.
+struct HistogramSnapshot {
+  std::vector<uint64_t> counts;  // per bucket, see LatencyHistogram
+
+  uint64_t count() const;
+  // the value below which p percent (0 to 100) of the samples are, 0 without samples;
+  // reported as the largest value of its bucket
+  uint64_t percentile(double p) const;
+  uint64_t max() const { return percentile(100); }
+  void merge(const HistogramSnapshot& other);
+};
+
+// Log-linear histogram of durations in nanoseconds, like HDR histograms: values below
+// kSubBuckets get one bucket each, above that every power of two is split into kSubBuckets
+// buckets of equal width, so a value is known to within 1 / kSubBuckets (12.5%) over the
+// whole range of uint64_t, in a fixed 4KB.
+class LatencyHistogram {
+ public:
+  static constexpr size_t kSubBucketBits = 3;
+  static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+  static constexpr size_t kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  static size_t bucket_of(uint64_t v) {
+    if (v < kSubBuckets) {
+      return static_cast<size_t>(v);
+    }
+    size_t shift = stats_detail::log2(v) - kSubBucketBits;
+    return (shift + 1) * kSubBuckets + static_cast<size_t>((v >> shift) - kSubBuckets);
+  }
+
+  // [lowest(b), highest(b)] are the values counted by bucket b
+  static uint64_t lowest(size_t b) {
+    if (b < kSubBuckets) {
+      return b;
+    }
+    size_t shift = b / kSubBuckets - 1;
+    return (kSubBuckets + b % kSubBuckets) << shift;
+  }
+  static uint64_t highest(size_t b) {
+    if (b < kSubBuckets) {
+      return b;
+    }
+    return lowest(b) + ((uint64_t(1) << (b / kSubBuckets - 1)) - 1);
+  }
+
+  // single writer, see stats_detail::Counter
+  void record(uint64_t ns) { counts_[bucket_of(ns)].add(); }
+  void record_shared(uint64_t ns) { counts_[bucket_of(ns)].add_shared(); }
+
+  HistogramSnapshot snapshot() const {
+    HistogramSnapshot s;
+    s.counts.resize(kBuckets);
+    for (size_t b = 0; b < kBuckets; b++) {
+      s.counts[b] = counts_[b].load();
+    }
+    return s;
+  }
+
+ private:
+  stats_detail::Counter counts_[kBuckets];
+};
+
+inline uint64_t HistogramSnapshot::count() const {
+  uint64_t n = 0;
+  for (uint64_t c : counts) {
+    n += c;
+  }
+  return n;
+}
+
+inline uint64_t HistogramSnapshot::percentile(double p) const {
+  uint64_t n = count();
+  if (n == 0) {
+    return 0;
+  }
+  // rank of the sample, 1-based
+  uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p / 100 * static_cast<double>(n) + 0.5));
+  uint64_t seen = 0;
+  for (size_t b = 0; b < counts.size(); b++) {
+    seen += counts[b];
+    if (seen >= rank) {
+      return LatencyHistogram::highest(b);
+    }
+  }
+  return LatencyHistogram::highest(counts.size() - 1);
+}
+
+inline void HistogramSnapshot::merge(const HistogramSnapshot& other) {
+  counts.resize(std::max(counts.size(), other.counts.size()));
+  for (size_t b = 0; b < other.counts.size(); b++) {
+    counts[b] += other.counts[b];
+  }
+}
+
+// a copy of the counters of one worker, see WorkerStats
+struct WorkerStatsSnapshot {
+  uint64_t tasks_run = 0;
+  uint64_t tasks_failed = 0;  // tasks which threw, see ThreadPoolOptions::on_error
+  uint64_t steal_attempts = 0;
+  uint64_t steals = 0;
+  uint64_t parks = 0;
+  std::chrono::nanoseconds parked_time{0};
+  size_t queue_depth = 0;  // tasks in the deques and inboxes of the worker at the snapshot
+  HistogramSnapshot queue_wait;
+  HistogramSnapshot run_time;
+
+  void merge(const WorkerStatsSnapshot& other) {
+    tasks_run += other.tasks_run;
+    tasks_failed += other.tasks_failed;
+    steal_attempts += other.steal_attempts;
+    steals += other.steals;
+    parks += other.parks;
+    parked_time += other.parked_time;
+    queue_depth += other.queue_depth;
+    queue_wait.merge(other.queue_wait);
+    run_time.merge(other.run_time);
+  }
+};
+
+// The counters of one worker, written by that worker only. Threads outside the pool which run
+// tasks through run_pending_task() share one WorkerStats with shared set.
+class WorkerStats {
+ public:
+  explicit WorkerStats(bool shared = false) : shared_(shared) {}
+
+  void task_run(uint64_t queue_wait_ns, uint64_t run_ns) {
+    add(tasks_run_);
+    if (shared_) {
+      queue_wait_.record_shared(queue_wait_ns);
+      run_time_.record_shared(run_ns);
+    } else {
+      queue_wait_.record(queue_wait_ns);
+      run_time_.record(run_ns);
+    }
+  }
+  void task_failed() { add(tasks_failed_); }
+  void steal_attempt(bool success) {
+    add(steal_attempts_);
+    if (success) {
+      add(steals_);
+    }
+  }
+  void parked(uint64_t ns) {
+    add(parks_);
+    add(parked_ns_, ns);
+  }
+
+  // everything but the queue depth, which belongs to the pool
+  WorkerStatsSnapshot snapshot() const {
+    WorkerStatsSnapshot s;
+    s.tasks_run = tasks_run_.load();
+    s.tasks_failed = tasks_failed_.load();
+    s.steal_attempts = steal_attempts_.load();
+    s.steals = steals_.load();
+    s.parks = parks_.load();
+    s.parked_time = std::chrono::nanoseconds(parked_ns_.load());
+    s.queue_wait = queue_wait_.snapshot();
+    s.run_time = run_time_.snapshot();
+    return s;
+  }
+
+ private:
+  void add(stats_detail::Counter& c, uint64_t n = 1) {
+    if (shared_) {
+      c.add_shared(n);
+    } else {
+      c.add(n);
+    }
+  }
+
+  bool shared_;
+  stats_detail::Counter tasks_run_;
+  stats_detail::Counter tasks_failed_;
+  stats_detail::Counter steal_attempts_;  // scans of the victims
+  stats_detail::Counter steals_;          // scans which found a task
+  stats_detail::Counter parks_;
+  stats_detail::Counter parked_ns_;
+  LatencyHistogram queue_wait_;  // from post() until a thread starts running the task
+  LatencyHistogram run_time_;
+};
+
+// ThreadPool::stats(). The counters are read one by one while the pool runs, so they are
+// consistent with each other only for an idle pool.
+struct ThreadPoolStats {
+  std::vector<WorkerStatsSnapshot> workers;  // one per worker slot
+  WorkerStatsSnapshot helpers;               // threads outside the pool in run_pending_task()
+  size_t threads = 0;                        // ThreadPool::size()
+  size_t pending = 0;                        // tasks not taken by any thread yet
+  size_t outstanding = 0;                    // tasks not finished yet
+
+  WorkerStatsSnapshot total() const {
+    WorkerStatsSnapshot sum = helpers;
+    for (auto& w : workers) {
+      sum.merge(w);
+    }
+    return sum;
+  }
+};
+
+}  // namespace hstl
+
+#endif  // THREAD_POOL_STATS_HPP_
@@ -0,0 +1,172 @@
+#ifndef TIMER_WHEEL_HPP_
+#define TIMER_WHEEL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace hstl {
+
+// Intrusive hook of a timer in a TimerWheel, a timer is linked in at most one wheel.
+struct TimerWheelNode {
+  TimerWheelNode* prev = nullptr;
+  TimerWheelNode* next = nullptr;
+  uint64_t deadline = 0;  // in ticks
+
+  bool linked() const { return prev != nullptr; }
+};
+
+// Hierarchical timing wheel (Varghese & Lauck), as in the Linux kernel: kLevels wheels of
+// kSlots slots, a timer is put on the lowest level whose span covers its distance from now,
+// in the slot of its deadline at that level. When a level wraps, the next slot of the level
+// above is cascaded, its timers are put again on lower levels.
+//
+// insert and erase are O(1), advance is O(1) per tick plus the cascaded timers. The wheel
+// does not own the nodes and is not thread safe. With 1ms ticks, timers up to 2^32 ticks
+// (49 days) away are placed exactly, later ones wait in the top level and are re-placed.
+class TimerWheel {
+ public:
+  static constexpr size_t kLevelBits = 8;
+  static constexpr size_t kSlots = size_t(1) << kLevelBits;
+  static constexpr size_t kLevels = 4;
+  static constexpr uint64_t kNever = std::numeric_limits<uint64_t>::max();
+
+  explicit TimerWheel(uint64_t now = 0) : now_(now), size_(0), slots_(kLevels * kSlots) {
+    for (auto& s : slots_) {
+      s.prev = s.next = &s;
+    }
+  }
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  uint64_t now() const { return now_; }
+  size_t size() const { return size_; }
+
+  // node->deadline must be set, a deadline which is not after now() fires at the next tick
+  void insert(TimerWheelNode* node) {
+    if (node->deadline <= now_) {
+      node->deadline = now_ + 1;
+    }
+    link(node);
+    size_++;
+  }
+
+  void erase(TimerWheelNode* node) {
+    unlink(node);
+    size_--;
+  }
+
+  // Moves the clock to tick now, calls expire(node) for every timer with deadline <= now,
+  // in deadline order. The node is unlinked before, expire may insert it again.
+  template <typename Expire>
+  void advance(uint64_t now, Expire&& expire) {
+    while (now_ < now) {
+      if (size_ == 0) {
+        now_ = now;
+        return;
+      }
+      now_++;
+      for (size_t level = 1; level < kLevels; level++) {
+        if ((now_ & ((uint64_t(1) << (level * kLevelBits)) - 1)) != 0) {
+          break;
+        }
+        cascade(level, expire);
+      }
+      TimerWheelNode& head = slot(0, now_);
+      while (head.next != &head) {
+        TimerWheelNode* node = head.next;
+        erase(node);
+        expire(node);
+      }
+    }
+  }
+
+  // unlinks every timer and calls f(node) for it, the clock stays
+  template <typename F>
+  void clear(F&& f) {
+    for (auto& head : slots_) {
+      while (head.next != &head) {
+        TimerWheelNode* node = head.next;
+        erase(node);
+        f(node);
+      }
+    }
+  }
+
+  // The next tick at which advance has something to do: a timer fires or a slot is cascaded.
+  // kNever for an empty wheel.
+  uint64_t next_event() const {
+    uint64_t next = kNever;
+    for (size_t level = 0; level < kLevels; level++) {
+      size_t shift = level * kLevelBits;
+      for (uint64_t k = 1; k <= kSlots; k++) {
+        uint64_t block = (now_ >> shift) + k;
+        if (!empty(level, block << shift)) {
+          if ((block << shift) < next) {
+            next = block << shift;
+          }
+          break;
+        }
+      }
+    }
+    return next;
+  }
+
+ private:
+  TimerWheelNode& slot(size_t level, uint64_t tick) {
+    return slots_[level * kSlots + ((tick >> (level * kLevelBits)) & (kSlots - 1))];
+  }
+
+  bool empty(size_t level, uint64_t tick) const {
+    const TimerWheelNode& head = slots_[level * kSlots + ((tick >> (level * kLevelBits)) & (kSlots - 1))];
+    return head.next == &head;
+  }
+
+  void link(TimerWheelNode* node) {
+    uint64_t distance = node->deadline - now_;
+    size_t level = 0;
+    while (level + 1 < kLevels && distance >= (uint64_t(1) << ((level + 1) * kLevelBits))) {
+      level++;
+    }
+    // beyond the top level: the last slot of the top level, placed again when it is cascaded
+    uint64_t tick = distance >> (kLevels * kLevelBits) == 0
+                        ? node->deadline
+                        : now_ + ((kSlots - 1) << ((kLevels - 1) * kLevelBits));
+    TimerWheelNode& head = slot(level, tick);
+    node->prev = head.prev;
+    node->next = &head;
+    head.prev->next = node;
+    head.prev = node;
+  }
+
+  static void unlink(TimerWheelNode* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node->next = nullptr;
+  }
+
+  template <typename Expire>
+  void cascade(size_t level, Expire& expire) {
+    TimerWheelNode& head = slot(level, now_);
+    while (head.next != &head) {
+      TimerWheelNode* node = head.next;
+      unlink(node);
+      if (node->deadline <= now_) {
+        size_--;
+        expire(node);
+      } else {
+        link(node);
+      }
+    }
+  }
+
+  uint64_t now_;
+  size_t size_;
+  std::vector<TimerWheelNode> slots_;  // sentinels of circular lists, level by level
+};
+
+}  // namespace hstl
+
+#endif  // TIMER_WHEEL_HPP_
@@ -0,0 +1,158 @@
+#ifndef WORK_STEALING_DEQUE_HPP_
+#define WORK_STEALING_DEQUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hstl {
+
+// Chase-Lev work stealing deque, following
+// "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013).
+//
+// Only the owner thread may call push()/pop(), which work on the bottom end (LIFO).
+// Any thread may call steal(), which takes from the top end (FIFO).
+// Elements are raw pointers so that a slot can be read and written atomically,
+// nullptr is returned when the deque is empty or a steal loses a race.
+template <typename T>
+class WorkStealingDeque {
+ public:
+  explicit WorkStealingDeque(size_t capacity = 256)
+      : top_(0), bottom_(0), array_(new Array(round_up(capacity))) {}
+
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  ~WorkStealingDeque() {
+    delete array_.load(std::memory_order_relaxed);
+    for (auto a : garbage_) {
+      delete a;
+    }
+  }
+
+  // owner only
+  void push(T* x) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    Array* a = array_.load(std::memory_order_relaxed);
+    if (b - t > a->capacity - 1) {
+      // thieves may still be reading the old array, it is reclaimed in the destructor
+      garbage_.push_back(a);
+      a = a->grow(b, t);
+      array_.store(a, std::memory_order_release);
+    }
+    a->put(b, x);
+    // publishes the slot to thieves (a release store rather than a release fence + relaxed
+    // store, same cost on x86 and visible to ThreadSanitizer)
+    bottom_.store(b + 1, std::memory_order_release);
+  }
+
+  // owner only
+  T* pop() {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Array* a = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+
+    if (t > b) {
+      // empty
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T* x = a->get(b);
+    if (t == b) {
+      // last element, race against thieves
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        x = nullptr;
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return x;
+  }
+
+  // any thread
+  T* steal() {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) {
+      return nullptr;
+    }
+    Array* a = array_.load(std::memory_order_acquire);
+    T* x = a->get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return x;
+  }
+
+  // approximate, may be stale as soon as it returns
+  size_t size() const {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    return b > t ? static_cast<size_t>(b - t) : 0;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  // Room for capacity elements before push() has to grow the array. Only while no other
+  // thread uses the deque (e.g. before the pool starts), the old array is freed right away.
+  void reserve(size_t capacity) {
+    Array* a = array_.load(std::memory_order_relaxed);
+    if (round_up(capacity) <= a->capacity) {
+      return;
+    }
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    Array* bigger = new Array(round_up(capacity));
+    for (int64_t i = t; i < b; ++i) {
+      bigger->put(i, a->get(i));
+    }
+    array_.store(bigger, std::memory_order_relaxed);
+    delete a;
+  }
+
+ private:
+  struct Array {
+    int64_t capacity;
+    int64_t mask;
+    std::atomic<T*>* buffer;
+
+    explicit Array(int64_t c)
+        : capacity(c), mask(c - 1), buffer(new std::atomic<T*>[c]) {}
+    ~Array() { delete[] buffer; }
+
+    T* get(int64_t i) const { return buffer[i & mask].load(std::memory_order_relaxed); }
+    void put(int64_t i, T* x) { buffer[i & mask].store(x, std::memory_order_relaxed); }
+
+    Array* grow(int64_t b, int64_t t) const {
+      Array* a = new Array(capacity * 2);
+      for (int64_t i = t; i != b; ++i) {
+        a->put(i, get(i));
+      }
+      return a;
+    }
+  };
+
+  static int64_t round_up(size_t n) {
+    int64_t c = 2;
+    while (c < static_cast<int64_t>(n)) {
+      c <<= 1;
+    }
+    return c;
+  }
+
+  // top_ is written by thieves and bottom_ by the owner, keep them on different cache lines
+  alignas(64) std::atomic<int64_t> top_;
+  alignas(64) std::atomic<int64_t> bottom_;
+  alignas(64) std::atomic<Array*> array_;
+  std::vector<Array*> garbage_;
+};
+
+}  // namespace hstl
+
+#endif  // WORK_STEALING_DEQUE_HPP_
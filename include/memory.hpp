@@ -1,15 +1,61 @@
 #ifndef MEMORY_HPP_
 #define MEMORY_HPP_
 
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <new>
 #include "iterator.hpp"
+#include "type_traits.hpp"
+#include "utility.hpp"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 
 namespace hstl {
 
-// TODO(hao): optimize using memmove exception safety
-// [first, last]范围内的对象拷贝到d_first开始的空间
-template<typename InputIt, typename NoThrowForwardIt>
-NoThrowForwardIt uninitialized_copy(InputIt first, InputIt last, NoThrowForwardIt d_first) {
+namespace memory_detail {
+
+// 源与目的都是指针、元素类型相同、且用Ref构造是平凡的：逐个构造等价于拷贝字节
+template <typename InputIt, typename ForwardIt, typename Ref>
+struct is_bitwise_constructible : false_type {};
+
+template <typename T, typename U, typename Ref>
+struct is_bitwise_constructible<T*, U*, Ref>
+    : integral_constant<bool, is_same_v<remove_cv_t<T>, U> && is_trivially_copyable_v<U> &&
+                                  is_trivially_constructible_v<U, Ref>> {};
+
+// 目的是指针、且用value构造是平凡的：构造一个副本后按字节填充
+template <typename ForwardIt, typename Ref>
+struct is_bitwise_fillable : false_type {};
+
+template <typename U, typename Ref>
+struct is_bitwise_fillable<U*, Ref>
+    : integral_constant<bool, is_trivially_copyable_v<U> && is_trivially_constructible_v<U, Ref>> {};
+
+template <typename T, typename U>
+U* bitwise_copy(T* first, T* last, U* d_first) {
+  size_t n = last - first;
+  // 空区间时指针可能为nullptr，不能传给memmove
+  if (n > 0) {
+    std::memmove(static_cast<void*>(d_first), static_cast<const void*>(first), n * sizeof(U));
+  }
+  return d_first + n;
+}
+
+template <typename InputIt, typename NoThrowForwardIt>
+NoThrowForwardIt uninitialized_copy(InputIt first, InputIt last, NoThrowForwardIt d_first, true_type) {
+  return bitwise_copy(first, last, d_first);
+}
+
+template <typename InputIt, typename NoThrowForwardIt>
+NoThrowForwardIt uninitialized_copy(InputIt first, InputIt last, NoThrowForwardIt d_first, false_type) {
   using T = typename iterator_traits<NoThrowForwardIt>::value_type;
   for (; first != last; ++d_first, (void) ++first) {
     ::new (static_cast<void*>(std::addressof(*d_first))) T(*first);
@@ -17,21 +63,62 @@ NoThrowForwardIt uninitialized_copy(InputIt first, InputIt last, NoThrowForwardI
   return d_first;
 }
 
-// 将[first, last)范围内的对象移动到d_first开始的空间
-template< typename InputIt, typename NoThrowForwardIt >
-NoThrowForwardIt uninitialized_move( InputIt first, InputIt last, NoThrowForwardIt d_first ) {
+template <typename InputIt, typename NoThrowForwardIt>
+NoThrowForwardIt uninitialized_move(InputIt first, InputIt last, NoThrowForwardIt d_first, true_type) {
+  return bitwise_copy(first, last, d_first);
+}
+
+template <typename InputIt, typename NoThrowForwardIt>
+NoThrowForwardIt uninitialized_move(InputIt first, InputIt last, NoThrowForwardIt d_first, false_type) {
   using T = typename iterator_traits<NoThrowForwardIt>::value_type;
   for (; first != last; ++d_first, (void) ++first) {
     // 优先使用移动构造函数， 如果移动构造函数不存在则使用拷贝构造函数
-    ::new (static_cast<void*>(std::addressof(*d_first))) T(move(*first));
+    ::new (static_cast<void*>(std::addressof(*d_first))) T(hstl::move(*first));
   }
   return d_first;
 }
 
-// TODO(hao): optimize
-// [first, first + count)范围内统一拷贝构造对象value
-template<typename ForwardIt, typename Size, typename T>
-ForwardIt uninitialized_fill_n(ForwardIt first, Size count, const T& value) {
+// 所有字节都相同时返回true，并通过byte返回该字节
+template <typename T>
+bool is_byte_pattern(const T& value, unsigned char& byte) {
+  // 有填充字节(或是浮点数)时字节不由值决定，不做比较
+  if constexpr (has_unique_object_representations_v<T>) {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, std::addressof(value), sizeof(T));
+    for (size_t i = 1; i < sizeof(T); ++i) {
+      if (bytes[i] != bytes[0]) {
+        return false;
+      }
+    }
+    byte = bytes[0];
+    return true;
+  } else {
+    return false;
+  }
+}
+
+template <typename ForwardIt, typename Size, typename T>
+ForwardIt uninitialized_fill_n(ForwardIt first, Size count, const T& value, true_type) {
+  using U = typename iterator_traits<ForwardIt>::value_type;
+  if (count <= 0) {
+    return first;
+  }
+  const U copy(value);
+  unsigned char byte;
+  // 如0、-1或char：一次memset
+  if (is_byte_pattern(copy, byte)) {
+    std::memset(static_cast<void*>(first), byte, static_cast<size_t>(count) * sizeof(U));
+    return first + count;
+  }
+  // 否则是平凡的赋值，编译器可以向量化
+  for (; count > 0; --count, (void) ++first) {
+    ::new (static_cast<void*>(first)) U(copy);
+  }
+  return first;
+}
+
+template <typename ForwardIt, typename Size, typename T>
+ForwardIt uninitialized_fill_n(ForwardIt first, Size count, const T& value, false_type) {
   using U = typename iterator_traits<ForwardIt>::value_type;
   for (; count > 0; --count, (void) ++first) {
     ::new (static_cast<void*>(std::addressof(*first))) U(value);
@@ -39,18 +126,180 @@ ForwardIt uninitialized_fill_n(ForwardIt first, Size count, const T& value) {
   return first;
 }
 
+template <typename Allocator, typename = void>
+struct has_allocate_at_least : false_type {};
+
+template <typename Allocator>
+struct has_allocate_at_least<Allocator, void_t<decltype(declval<Allocator&>().allocate_at_least(size_t()))>>
+    : true_type {};
+
+template <typename Allocator, typename = void>
+struct has_reallocate : false_type {};
+
+template <typename Allocator>
+struct has_reallocate<Allocator, void_t<decltype(declval<Allocator&>().reallocate(
+                                     declval<typename std::allocator_traits<Allocator>::pointer>(), size_t(),
+                                     size_t()))>> : true_type {};
+
+}  // namespace memory_detail
+
+// C++23 std::allocation_result
+template <typename Pointer>
+struct allocation_result {
+  Pointer ptr;
+  size_t count;
+};
+
+// 至少n个元素的内存(C++23 std::allocator_traits::allocate_at_least)
+// 分配器有allocate_at_least时count可能大于n，释放时要传入count；否则count为n
+template <typename Allocator>
+allocation_result<typename std::allocator_traits<Allocator>::pointer> allocate_at_least(Allocator& alloc,
+                                                                                       size_t n) {
+  if constexpr (memory_detail::has_allocate_at_least<Allocator>::value) {
+    auto result = alloc.allocate_at_least(n);
+    return {result.ptr, result.count};
+  } else {
+    return {alloc.allocate(n), n};
+  }
+}
+
+// 基于malloc的分配器
+// allocate_at_least返回malloc实际给出的大小(glibc的malloc_usable_size)，即向上取整到size class
+// 在Linux上，不小于kHugePageSize的内存中对齐的部分madvise(MADV_HUGEPAGE)，
+// 透明大页为madvise模式时也能用上huge page
+// malloc和realloc只保证alignof(std::max_align_t)的对齐，不支持对齐要求更高的类型
+template <typename T>
+class malloc_allocator {
+  static_assert(alignof(T) <= alignof(std::max_align_t),
+                "malloc_allocator cannot allocate over-aligned types");
+
+ public:
+  using value_type = T;
+
+  static constexpr size_t kHugePageSize = size_t(2) << 20;
+
+  malloc_allocator() noexcept = default;
+  template <typename U>
+  malloc_allocator(const malloc_allocator<U>&) noexcept {}
+
+  T* allocate(size_t n) { return allocate_at_least(n).ptr; }
+
+  allocation_result<T*> allocate_at_least(size_t n) {
+    if (n > static_cast<size_t>(-1) / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    size_t bytes = n == 0 ? 1 : n * sizeof(T);
+    void* p = std::malloc(bytes);
+    if (p == nullptr) {
+      throw std::bad_alloc();
+    }
+#if defined(__linux__)
+    if (bytes >= kHugePageSize) {
+      // 只有其中对齐的2MB才能用huge page，不必为对齐多分配
+      uintptr_t begin = (reinterpret_cast<uintptr_t>(p) + kHugePageSize - 1) & ~(kHugePageSize - 1);
+      uintptr_t end = (reinterpret_cast<uintptr_t>(p) + bytes) & ~(kHugePageSize - 1);
+      if (begin < end) {
+        madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);
+      }
+    }
+#endif
+#if defined(__GLIBC__)
+    size_t count = malloc_usable_size(p) / sizeof(T);
+#else
+    size_t count = n;
+#endif
+    return {static_cast<T*>(p), count < n ? n : count};
+  }
+
+  // 把n个元素的内存扩展(或缩小)到至少new_n个元素，字节原样保留，失败时抛出异常且p不变。
+  // 只能用于可平凡重定位的元素。glibc对大块内存用mremap，不拷贝页面
+  allocation_result<T*> reallocate(T* p, size_t /* n */, size_t new_n) {
+    if (new_n > static_cast<size_t>(-1) / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    void* q = std::realloc(static_cast<void*>(p), new_n == 0 ? 1 : new_n * sizeof(T));
+    if (q == nullptr) {
+      throw std::bad_alloc();
+    }
+#if defined(__GLIBC__)
+    size_t count = malloc_usable_size(q) / sizeof(T);
+#else
+    size_t count = new_n;
+#endif
+    return {static_cast<T*>(q), count < new_n ? new_n : count};
+  }
+
+  void deallocate(T* p, size_t /* n */) noexcept { std::free(p); }
+};
+
+template <typename T, typename U>
+bool operator==(const malloc_allocator<T>&, const malloc_allocator<U>&) noexcept {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const malloc_allocator<T>&, const malloc_allocator<U>&) noexcept {
+  return false;
+}
+
+// TODO(hao): exception safety
+// [first, last]范围内的对象拷贝到d_first开始的空间
+// 指针区间且元素可平凡拷贝(如int、POD结构体)时使用memmove
+template<typename InputIt, typename NoThrowForwardIt>
+NoThrowForwardIt uninitialized_copy(InputIt first, InputIt last, NoThrowForwardIt d_first) {
+  return memory_detail::uninitialized_copy(
+      first, last, d_first,
+      memory_detail::is_bitwise_constructible<InputIt, NoThrowForwardIt, decltype(*first)>());
+}
+
+// 将[first, last)范围内的对象移动到d_first开始的空间
+// 指针区间且元素可平凡拷贝时使用memmove
+template< typename InputIt, typename NoThrowForwardIt >
+NoThrowForwardIt uninitialized_move( InputIt first, InputIt last, NoThrowForwardIt d_first ) {
+  return memory_detail::uninitialized_move(
+      first, last, d_first,
+      memory_detail::is_bitwise_constructible<InputIt, NoThrowForwardIt, decltype(hstl::move(*first))>());
+}
+
+// [first, first + count)范围内统一拷贝构造对象value
+// 指针区间且元素可平凡拷贝时：value的所有字节都相同则使用memset
+template<typename ForwardIt, typename Size, typename T>
+ForwardIt uninitialized_fill_n(ForwardIt first, Size count, const T& value) {
+  return memory_detail::uninitialized_fill_n(first, count, value,
+                                             memory_detail::is_bitwise_fillable<ForwardIt, const T&>());
+}
+
+// 可平凡析构的类型(如int、POD结构体)什么都不做
 template< typename T >
 void destroy_at( T* p ) {
-  p->~T();
+  if constexpr (!is_trivially_destructible_v<T>) {
+    p->~T();
+  }
 }
 
+// 可平凡析构时不遍历区间，O(1)
 template< typename ForwardIt >
 void destroy( ForwardIt first, ForwardIt last ) {
-  for (; first != last; ++first) {
-    destroy_at(std::addressof(*first));
+  if constexpr (!is_trivially_destructible_v<typename iterator_traits<ForwardIt>::value_type>) {
+    for (; first != last; ++first) {
+      hstl::destroy_at(std::addressof(*first));
+    }
+  }
+}
+
+// 将[first, last)范围内的对象搬到d_first开始的空间，原对象的生命周期结束(不需要再析构)
+// 可平凡重定位的元素(如int、unique_ptr、shared_ptr)使用memmove，否则移动构造后析构原对象
+template <typename T>
+T* uninitialized_relocate(T* first, T* last, T* d_first) {
+  if constexpr (is_trivially_relocatable_v<T>) {
+    return memory_detail::bitwise_copy(first, last, d_first);
+  } else {
+    T* d_last = hstl::uninitialized_move(first, last, d_first);
+    hstl::destroy(first, last);
+    return d_last;
   }
 }
 
 } // namespace hstl
 
-#endif  // MEMORY_HPP_
\ No newline at end of file
+#endif  // MEMORY_HPP_
@@ -7,6 +7,7 @@
 
 #include "internal/smart_ptr.hpp"
 #include "internal/compressed_pair.hpp"
+#include "type_traits.hpp"
 #include "utility.hpp"
 
 namespace hstl {
@@ -463,6 +464,13 @@ class weak_ptr {
   counter* count_;
 };
 
+// 只有两个指针，计数器不知道自己被哪个对象引用
+template <typename T>
+struct is_trivially_relocatable<shared_ptr<T>> : true_type {};
+
+template <typename T>
+struct is_trivially_relocatable<weak_ptr<T>> : true_type {};
+
 }  // namespace hstl
 
 #endif  // SHARED_PTR_HPP_
\ No newline at end of file
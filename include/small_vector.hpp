@@ -0,0 +1,246 @@
+#ifndef SMALL_VECTOR_HPP_
+#define SMALL_VECTOR_HPP_
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+
+#include "iterator.hpp"
+#include "memory.hpp"
+#include "span.hpp"
+#include "type_traits.hpp"
+#include "utility.hpp"
+#include "vector.hpp"
+
+namespace hstl {
+
+namespace small_vector_detail {
+
+// 内联缓冲区放在分配器里，也就是VectorBase的compressed_pair中，vector不需要知道它的存在：
+// small_vector一开始指向缓冲区且容量为N，超过N时vector照常通过分配器分配，释放缓冲区时什么都不做。
+// 拷贝分配器不会拷贝缓冲区，因此small_vector自己实现拷贝、移动和交换
+template <typename T, size_t N, typename Allocator>
+class inline_allocator {
+ public:
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = inline_allocator<U, N, typename std::allocator_traits<Allocator>::template rebind_alloc<U>>;
+  };
+
+  inline_allocator() = default;
+  explicit inline_allocator(const Allocator& alloc) : alloc_(alloc) {}
+  inline_allocator(const inline_allocator& other) : alloc_(other.alloc_) {}
+  inline_allocator& operator=(const inline_allocator& other) {
+    alloc_ = other.alloc_;
+    return *this;
+  }
+
+  T* allocate(size_t n) { return alloc_.allocate(n); }
+  allocation_result<T*> allocate_at_least(size_t n) { return hstl::allocate_at_least(alloc_, n); }
+
+  void deallocate(T* p, size_t n) {
+    if (p != buffer()) {
+      alloc_.deallocate(p, n);
+    }
+  }
+
+  T* buffer() noexcept { return reinterpret_cast<T*>(buffer_); }
+  const T* buffer() const noexcept { return reinterpret_cast<const T*>(buffer_); }
+
+  const Allocator& inner() const noexcept { return alloc_; }
+
+ private:
+  Allocator alloc_;
+  alignas(T) unsigned char buffer_[N * sizeof(T)];
+};
+
+}  // namespace small_vector_detail
+
+// 最多N个元素时放在对象内部，不分配内存；超过N个时与vector相同(元素搬到堆上，之后不再回到内部，
+// 除非shrink_to_fit)。API与vector相同，可以隐式转换为span
+// 注意：移动和交换内联的small_vector需要逐个移动元素，迭代器会失效
+//
+// 私有继承：vector的swap、operator=、shrink_to_fit会连同分配器(也就是内联缓冲区的地址)一起交换或拷贝，
+// 另一个对象就会持有指向这个对象内部的指针，并在释放时把它交给真正的分配器。
+// 所以small_vector不能转换为vector&，这些成员由small_vector自己实现，其余的用using导出
+template <typename T, size_t N, typename Allocator = std::allocator<T>, typename GrowthPolicy = doubling_growth>
+class small_vector : private vector<T, small_vector_detail::inline_allocator<T, N, Allocator>, GrowthPolicy> {
+  static_assert(N > 0, "small_vector needs room for at least one element");
+
+  using base_type = vector<T, small_vector_detail::inline_allocator<T, N, Allocator>, GrowthPolicy>;
+  using base_type::begin_;
+  using base_type::end_;
+  using base_type::capacity_;
+
+ public:
+  using typename base_type::size_type;
+  using typename base_type::difference_type;
+  using typename base_type::value_type;
+  using typename base_type::reference;
+  using typename base_type::const_reference;
+  using typename base_type::pointer;
+  using typename base_type::const_pointer;
+  using typename base_type::iterator;
+  using typename base_type::const_iterator;
+  using allocator_type = Allocator;
+
+  using base_type::at;
+  using base_type::operator[];
+  using base_type::front;
+  using base_type::back;
+  using base_type::data;
+
+  using base_type::begin;
+  using base_type::cbegin;
+  using base_type::end;
+  using base_type::cend;
+
+  using base_type::empty;
+  using base_type::size;
+  using base_type::max_size;
+  using base_type::reserve;
+  using base_type::capacity;
+
+  using base_type::clear;
+  using base_type::insert;
+  using base_type::emplace;
+  using base_type::erase;
+  using base_type::push_back;
+  using base_type::emplace_back;
+  using base_type::pop_back;
+  using base_type::resize;
+
+  // 内联缓冲区的容量
+  static constexpr size_type kInlineCapacity = N;
+
+  small_vector() { reset(); }
+  explicit small_vector(const Allocator& alloc) : base_type(typename base_type::allocator_type(alloc)) {
+    reset();
+  }
+  explicit small_vector(size_type count, const Allocator& alloc = Allocator()) : small_vector(alloc) {
+    this->resize(count);
+  }
+  small_vector(size_type count, const value_type& value, const Allocator& alloc = Allocator())
+      : small_vector(alloc) {
+    this->resize(count, value);
+  }
+  template <typename InputIt, typename = typename iterator_traits<InputIt>::value_type>
+  small_vector(InputIt first, InputIt last, const Allocator& alloc = Allocator()) : small_vector(alloc) {
+    append(first, last);
+  }
+  small_vector(std::initializer_list<value_type> l, const Allocator& alloc = Allocator())
+      : small_vector(l.begin(), l.end(), alloc) {}
+  small_vector(const small_vector& other) : small_vector(other.begin(), other.end(), other.get_allocator()) {}
+  small_vector(small_vector&& other) : small_vector(other.get_allocator()) { take(other); }
+
+  small_vector& operator=(const small_vector& other) {
+    if (this != &other) {
+      this->clear();
+      append(other.begin(), other.end());
+    }
+    return *this;
+  }
+  small_vector& operator=(small_vector&& other) {
+    if (this != &other) {
+      release();
+      take(other);
+    }
+    return *this;
+  }
+  small_vector& operator=(std::initializer_list<value_type> l) {
+    this->clear();
+    append(l.begin(), l.end());
+    return *this;
+  }
+
+  void assign(size_type count, const value_type& value) {
+    // value可能引用其中的元素
+    value_type copy(value);
+    this->clear();
+    this->resize(count, copy);
+  }
+  void assign(std::initializer_list<value_type> l) { *this = l; }
+
+  allocator_type get_allocator() const { return capacity_.second().inner(); }
+
+  // 元素是否在对象内部(没有分配内存)
+  bool is_inline() const { return begin_ == capacity_.second().buffer(); }
+
+  // 不超过N个元素时回到内部
+  void shrink_to_fit();
+
+  void swap(small_vector& other) {
+    small_vector tmp(hstl::move(other));
+    other = hstl::move(*this);
+    *this = hstl::move(tmp);
+  }
+
+ private:
+  // 指向内联缓冲区，为空
+  void reset() {
+    begin_ = capacity_.second().buffer();
+    end_ = begin_;
+    capacity_.first() = begin_ + N;
+  }
+
+  // 释放元素和内存，回到内联状态
+  void release() {
+    this->clear();
+    if (!is_inline()) {
+      capacity_.second().deallocate(begin_, this->capacity());
+      reset();
+    }
+  }
+
+  // 拿走other的元素，this为空且在内联状态；other也回到内联状态
+  void take(small_vector& other) {
+    if (other.is_inline()) {
+      end_ = hstl::uninitialized_relocate(other.begin_, other.end_, begin_);
+      other.end_ = other.begin_;
+    } else {
+      begin_ = other.begin_;
+      end_ = other.end_;
+      capacity_.first() = other.capacity_.first();
+      other.reset();
+    }
+  }
+
+  template <typename InputIt>
+  void append(InputIt first, InputIt last) {
+    if constexpr (is_pointer_v<InputIt>) {
+      // 一次扩容，可平凡拷贝的元素用memmove
+      this->reserve(this->size() + (last - first));
+      end_ = hstl::uninitialized_copy(first, last, end_);
+    } else {
+      for (; first != last; ++first) {
+        this->emplace_back(*first);
+      }
+    }
+  }
+};
+
+template <typename T, size_t N, typename Allocator, typename GrowthPolicy>
+void small_vector<T, N, Allocator, GrowthPolicy>::shrink_to_fit() {
+  if (is_inline() || this->size() == this->capacity()) {
+    return;
+  }
+  T* old = begin_;
+  size_type old_capacity = this->capacity();
+  size_type n = this->size();
+  T* mem = n <= N ? capacity_.second().buffer() : capacity_.second().allocate(n);
+  end_ = hstl::uninitialized_relocate(begin_, end_, mem);
+  begin_ = mem;
+  capacity_.first() = begin_ + (n <= N ? N : n);
+  capacity_.second().deallocate(old, old_capacity);
+}
+
+template <typename T, size_t N, typename Allocator, typename GrowthPolicy>
+void swap(small_vector<T, N, Allocator, GrowthPolicy>& lhs, small_vector<T, N, Allocator, GrowthPolicy>& rhs) {
+  lhs.swap(rhs);
+}
+
+}  // namespace hstl
+
+#endif  // SMALL_VECTOR_HPP_
@@ -0,0 +1,60 @@
+#ifndef SPAN_HPP_
+#define SPAN_HPP_
+
+#include <cassert>
+#include <cstddef>
+
+#include "type_traits.hpp"
+#include "utility.hpp"
+
+namespace hstl {
+
+// 连续内存的视图(C++20 std::span的子集，只有动态长度)：一个指针和一个长度，不拥有元素
+template <typename T>
+class span {
+ public:
+  using element_type = T;
+  using value_type = remove_cv_t<T>;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using pointer = T*;
+  using reference = T&;
+  using iterator = T*;
+
+  constexpr span() noexcept : data_(nullptr), size_(0) {}
+  constexpr span(T* data, size_type size) noexcept : data_(data), size_(size) {}
+
+  // 有data()和size()的容器，如vector、small_vector
+  template <typename Container,
+            typename = enable_if_t<!is_same_v<remove_cv_t<remove_reference_t<Container>>, span>>,
+            typename = void_t<decltype(static_cast<T*>(declval<Container&>().data())),
+                              decltype(declval<Container&>().size())>>
+  constexpr span(Container& c) noexcept : data_(c.data()), size_(c.size()) {}
+
+  constexpr T* data() const noexcept { return data_; }
+  constexpr size_type size() const noexcept { return size_; }
+  constexpr bool empty() const noexcept { return size_ == 0; }
+
+  constexpr iterator begin() const noexcept { return data_; }
+  constexpr iterator end() const noexcept { return data_ + size_; }
+
+  constexpr reference operator[](size_type i) const {
+    assert(i < size_);
+    return data_[i];
+  }
+  constexpr reference front() const { return data_[0]; }
+  constexpr reference back() const { return data_[size_ - 1]; }
+
+  constexpr span subspan(size_type offset, size_type count) const {
+    assert(offset + count <= size_);
+    return span(data_ + offset, count);
+  }
+
+ private:
+  T* data_;
+  size_type size_;
+};
+
+}  // namespace hstl
+
+#endif  // SPAN_HPP_
@@ -187,6 +187,86 @@ struct conditional<true, T, F> {
 template <bool B, typename T, typename F>
 using conditional_t = typename conditional<B, T, F>::type;
 
+// ---------------- remove_cv ------------------ //
+template <typename T>
+struct remove_const {
+  using type = T;
+};
+
+template <typename T>
+struct remove_const<const T> {
+  using type = T;
+};
+
+template <typename T>
+struct remove_volatile {
+  using type = T;
+};
+
+template <typename T>
+struct remove_volatile<volatile T> {
+  using type = T;
+};
+
+template <typename T>
+struct remove_cv {
+  using type = typename remove_volatile<typename remove_const<T>::type>::type;
+};
+
+template <typename T>
+using remove_cv_t = typename remove_cv<T>::type;
+
+// ---------------- is_trivially_copyable ------------------ //
+// 以下特性无法在语言内实现，依赖编译器内建函数(gcc/clang/msvc均支持)
+// 可以用memcpy拷贝的类型
+template <typename T>
+struct is_trivially_copyable : integral_constant<bool, __is_trivially_copyable(T)> {};
+
+template <typename T>
+constexpr bool is_trivially_copyable_v = is_trivially_copyable<T>::value;
+
+// ---------------- is_trivially_constructible ------------------ //
+// T(Args...)不调用任何用户代码，如is_trivially_constructible<T, const T&>对应平凡的拷贝构造
+template <typename T, typename... Args>
+struct is_trivially_constructible : integral_constant<bool, __is_trivially_constructible(T, Args...)> {};
+
+template <typename T, typename... Args>
+constexpr bool is_trivially_constructible_v = is_trivially_constructible<T, Args...>::value;
+
+// ---------------- is_trivially_destructible ------------------ //
+// 析构函数什么都不做，可以不调用(要求T可析构)
+// clang已将__has_trivial_destructor标记为deprecated
+template <typename T>
+struct is_trivially_destructible
+#if defined(__clang__)
+    : integral_constant<bool, __is_trivially_destructible(T)> {};
+#else
+    : integral_constant<bool, __has_trivial_destructor(T)> {};
+#endif
+
+template <typename T>
+constexpr bool is_trivially_destructible_v = is_trivially_destructible<T>::value;
+
+// ---------------- is_trivially_relocatable ------------------ //
+// 可以用memcpy搬到别处，之后不再析构原对象(P1144)
+// 默认为可平凡拷贝且可平凡析构的类型；没有指向自身的指针的类型可以特化为true_type，
+// 如unique_ptr、shared_ptr(移动构造+析构原对象等价于拷贝字节)
+template <typename T>
+struct is_trivially_relocatable
+    : integral_constant<bool, is_trivially_copyable_v<T> && is_trivially_destructible_v<T>> {};
+
+template <typename T>
+constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// ---------------- has_unique_object_representations ------------------ //
+// 值相等等价于字节相等(没有填充字节，也不是浮点数)
+template <typename T>
+struct has_unique_object_representations
+    : integral_constant<bool, __has_unique_object_representations(T)> {};
+
+template <typename T>
+constexpr bool has_unique_object_representations_v = has_unique_object_representations<T>::value;
+
 // ---------------- void_t ------------------ //
 template<typename... >
 using void_t = void;
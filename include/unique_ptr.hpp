@@ -90,6 +90,10 @@ class unique_ptr {
   compressed_pair<pointer, deleter_type> pair_;
 };
 
+// 只有一个指针和删除器
+template <typename T, typename Deleter>
+struct is_trivially_relocatable<unique_ptr<T, Deleter>> : is_trivially_relocatable<Deleter> {};
+
 // http://stackoverflow.com/questions/12580432/why-does-c11-have-make-shared-but-not-make-unique
 // http://herbsutter.com/2013/05/29/gotw-89-solution-smart-pointers/
 template <typename T, typename... Args>
@@ -14,6 +14,37 @@
 
 namespace hstl {
 
+// 扩容策略：grow(capacity, element_size)返回扩容后的容量(元素个数)，vector保证不小于所需的大小
+
+// 2倍，默认
+struct doubling_growth {
+  static size_t grow(size_t capacity, size_t /* element_size */) {
+    return capacity == 0 ? 1 : capacity * 2;
+  }
+};
+
+// 1.5倍：最多浪费1/3而不是1/2的内存；此前释放的内存块加起来最终能放下新的内存块，分配器有机会复用
+struct one_and_half_growth {
+  static size_t grow(size_t capacity, size_t /* element_size */) {
+    return capacity < 2 ? capacity + 1 : capacity + capacity / 2;
+  }
+};
+
+// 不小于Threshold字节后，在Base的基础上向上取整到PageSize(默认2MB的huge page)的整数倍，
+// 配合malloc_allocator(大块内存按huge page对齐)不会有半个huge page被浪费
+template <typename Base = one_and_half_growth, size_t Threshold = (size_t(32) << 20),
+          size_t PageSize = (size_t(2) << 20)>
+struct huge_page_growth {
+  static size_t grow(size_t capacity, size_t element_size) {
+    size_t next = Base::grow(capacity, element_size);
+    size_t bytes = next * element_size;
+    if (bytes < Threshold) {
+      return next;
+    }
+    return (bytes + PageSize - 1) / PageSize * PageSize / element_size;
+  }
+};
+
 template <typename T, typename Allocator>
 class VectorBase {
   using size_type = size_t;
@@ -44,20 +75,31 @@ class VectorBase {
   static constexpr size_type kMaxSize = static_cast<size_type>(-2); 
 
   protected:
+  // 分配器可能多给(allocate_at_least，如malloc_allocator的size class)，n更新为实际的容量
+  T* allocate_at_least(size_type& n) {
+    auto result = hstl::allocate_at_least(capacity_.second(), n);
+    n = result.count;
+    return result.ptr;
+  }
+
   T* begin_;
   T* end_;
   compressed_pair<T*, allocator_type> capacity_;
 };
 
 // T: 要求是完整类型且Erasable (C++ 11 - 17)
-template <typename T, typename Allocator = std::allocator<T>>
+// GrowthPolicy: 扩容策略，见doubling_growth
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = doubling_growth>
 class vector: public VectorBase<T, Allocator> {
   static_assert(hstl::is_same_v<T, typename Allocator::value_type>,
                 "Allocator::value_type must be same as T");
-  template <typename U, typename Allocator2>
-  friend void swap(vector<U, Allocator2>& lhs, vector<U, Allocator2>& rhs);
-  
+  template <typename U, typename Allocator2, typename GrowthPolicy2>
+  friend void swap(vector<U, Allocator2, GrowthPolicy2>& lhs, vector<U, Allocator2, GrowthPolicy2>& rhs);
+
+ protected:
+  // small_vector也要用到
   using base_type = VectorBase<T, Allocator>;
+  using base_type::allocate_at_least;
   using base_type::begin_;
   using base_type::end_;
   using base_type::capacity_;
@@ -169,10 +211,22 @@ class vector: public VectorBase<T, Allocator> {
   void swap(vector& other);
   /* ------------- Modifiers ------------- */
 private:
-  size_type get_new_capacity(size_type current_capacity) {
-    return current_capacity == 0 ? 1 : current_capacity * 2;
+  // 至少required个元素
+  size_type get_new_capacity(size_type required) {
+    size_type new_cap = GrowthPolicy::grow(capacity(), sizeof(T));
+    return new_cap < required ? required : new_cap;
   }
 
+  // 元素可平凡重定位且分配器有reallocate(如malloc_allocator)时，扩容直接realloc，
+  // 大块内存可以原地扩展或mremap，不需要新分配再逐个搬运
+  static constexpr bool kReallocate =
+      is_trivially_relocatable_v<T> && memory_detail::has_reallocate<Allocator>::value;
+
+  // 把元素搬到mem(容量new_cap)，释放旧的内存
+  void relocate_to(pointer mem, size_type new_cap);
+  // 扩容到至少new_cap个元素
+  void reallocate(size_type new_cap);
+
   iterator do_insert_range(iterator position, size_type n, const value_type& value);
   template<typename... Args>
   iterator do_insert(iterator position, Args&&... args);
@@ -180,42 +234,42 @@ private:
   iterator do_insert_back(Args&&... args);
 };
 
-template <typename T, typename Allocator>
-vector<T, Allocator>::vector(const Allocator& alloc)
+template <typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>::vector(const Allocator& alloc)
 : VectorBase<T, Allocator>(alloc) {}
 
-template <typename T, typename Allocator>
-vector<T, Allocator>::vector(const vector& other)
+template <typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>::vector(const vector& other)
 : VectorBase<T, Allocator>(other.size(), other.capacity_.second()) {
-  uninitialized_copy(other.begin_, other.end_, begin_);
+  hstl::uninitialized_copy(other.begin_, other.end_, begin_);
   end_ += other.size();
 }
 
-template <typename T, typename Allocator>
-vector<T, Allocator>::vector(size_type size, const Allocator& alloc)
+template <typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>::vector(size_type size, const Allocator& alloc)
 : VectorBase<T, Allocator>(size, alloc) {
-  uninitialized_fill_n(begin_, size, value_type());
+  hstl::uninitialized_fill_n(begin_, size, value_type());
   end_ += size;
 }
 
-template <typename T, typename Allocator>
-vector<T, Allocator>::vector(size_type size, const value_type& value, const Allocator& alloc)
+template <typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>::vector(size_type size, const value_type& value, const Allocator& alloc)
 : VectorBase<T, Allocator>(size, alloc) {
-  uninitialized_fill_n(begin_, size, value);
+  hstl::uninitialized_fill_n(begin_, size, value);
   end_ += size;
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename GrowthPolicy>
 template<typename InputIt, typename>
-vector<T, Allocator>::vector(InputIt first, InputIt last, const Allocator& alloc)
+vector<T, Allocator, GrowthPolicy>::vector(InputIt first, InputIt last, const Allocator& alloc)
 : VectorBase<T, Allocator>(last - first, alloc) {
-  uninitialized_copy(first, last, begin_);
+  hstl::uninitialized_copy(first, last, begin_);
   end_ += last - first;
 }
 
-template <typename T, typename Allocator>
-vector<T, Allocator>::vector(vector&& other)
-: VectorBase<T, Allocator>(move(other.capacity_.second())) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>::vector(vector&& other)
+: VectorBase<T, Allocator>(hstl::move(other.capacity_.second())) {
   begin_ = other.begin_;
   end_ = other.end_;
   capacity_.first() = other.capacity_.first();
@@ -225,32 +279,32 @@ vector<T, Allocator>::vector(vector&& other)
   other.capacity_.first() = nullptr;
 }
 
-template <typename T, typename Allocator>
-vector<T, Allocator>::vector(std::initializer_list<value_type> l, const Allocator& alloc)
+template <typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>::vector(std::initializer_list<value_type> l, const Allocator& alloc)
   : vector(l.begin(), l.end(), alloc) {}
 
-// TODO(hao): is_trivially_destructible
-template <typename T, typename Allocator>
-vector<T, Allocator>::~vector() {
-  destroy(begin_, end_);
+// 可平凡析构的元素不需要逐个析构，destroy为空
+template <typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>::~vector() {
+  hstl::destroy(begin_, end_);
 };
 
-template <typename T, typename Allocator>
-vector<T, Allocator>& vector<T, Allocator>::operator=(const vector& other) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>& vector<T, Allocator, GrowthPolicy>::operator=(const vector& other) {
   vector(other).swap(*this);
   return *this;
 }
 
-template <typename T, typename Allocator>
-void vector<T, Allocator>::assign(size_type count, const T& value) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::assign(size_type count, const T& value) {
   // 1. count比当前容量大，需要重新分配内存
-  if (count > capacity_.first() - begin_) {
+  if (count > capacity()) {
     vector(count, value, capacity_.second()).swap(*this);
   } 
   // 2. count比当前size大，需要填充value
   else if (count > size()) {
     std::fill(begin_, end_, value);
-    uninitialized_fill_n(end_, count - size(), value);
+    hstl::uninitialized_fill_n(end_, count - size(), value);
   } 
   // 3. count比当前size小，需要析构多余的元素
   else {
@@ -261,80 +315,98 @@ void vector<T, Allocator>::assign(size_type count, const T& value) {
 // TODO(hao): move
 // reserve() cannot be used to reduce the capacity of 
 // the container; to that end shrink_to_fit() is provided.
-template <typename T, typename Allocator>
-void vector<T, Allocator>::reserve( size_type new_cap ) {
-  if (new_cap <= capacity_.first() - begin_) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::reserve( size_type new_cap ) {
+  if (new_cap <= capacity()) {
     return;
   }
-  auto mem = capacity_.second().allocate(new_cap);
-  uninitialized_move(begin_, end_, mem);
-  auto s = size();
-  
-  destroy(begin_, end_);
-  capacity_.second().deallocate(begin_, capacity_.first() - begin_);
+  reallocate(new_cap);
+}
 
+template <typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::relocate_to(pointer mem, size_type new_cap) {
+  auto s = size();
+  hstl::uninitialized_relocate(begin_, end_, mem);
+  if (begin_) {
+    capacity_.second().deallocate(begin_, capacity_.first() - begin_);
+  }
   begin_ = mem;
   end_ = begin_ + s;
   capacity_.first() = begin_ + new_cap;
 }
 
+template <typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::reallocate(size_type new_cap) {
+  if constexpr (kReallocate) {
+    if (begin_) {
+      auto s = size();
+      auto result = capacity_.second().reallocate(begin_, capacity(), new_cap);
+      begin_ = result.ptr;
+      end_ = begin_ + s;
+      capacity_.first() = begin_ + result.count;
+      return;
+    }
+  }
+  auto mem = allocate_at_least(new_cap);
+  relocate_to(mem, new_cap);
+}
+
 // TODO(hao): move_iterator
-template <typename T, typename Allocator>
-void vector<T, Allocator>::shrink_to_fit() {
+template <typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::shrink_to_fit() {
   vector(begin_, end_, capacity_.second()).swap(*this);
 }
 
-template <typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::insert( const_iterator pos, const T& value ) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::insert( const_iterator pos, const T& value ) {
   return do_insert(const_cast<iterator>(pos), value);
 }
 
 // TODO(hao): move_iterator
-template <typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::insert( const_iterator pos, T&& value ) {
-  return do_insert(const_cast<iterator>(pos), forward<T>(value));
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::insert( const_iterator pos, T&& value ) {
+  return do_insert(const_cast<iterator>(pos), hstl::forward<T>(value));
 }
 
-template <typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::insert( const_iterator pos, size_type count, const T& value ) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::insert( const_iterator pos, size_type count, const T& value ) {
   return do_insert_range(const_cast<iterator>(pos), count, value);
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename GrowthPolicy>
 template<typename... Args>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::emplace(const_iterator pos, Args&&... args) {
-  return do_insert(const_cast<iterator>(pos), forward<Args>(args)...);
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::emplace(const_iterator pos, Args&&... args) {
+  return do_insert(const_cast<iterator>(pos), hstl::forward<Args>(args)...);
 }
 
-template<typename T, typename Allocator>
+template <typename T, typename Allocator, typename GrowthPolicy>
 template<typename... Args>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::do_insert(iterator pos, Args&&... args) {
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::do_insert(iterator pos, Args&&... args) {
   if (size() < capacity()) {
     // move_backward采用赋值运算符，move到的位置上必须已经有对象
-    ::new (static_cast<void*>(end_)) value_type(move(*(end_ - 1)));
+    ::new (static_cast<void*>(end_)) value_type(hstl::move(*(end_ - 1)));
     std::move_backward(pos, end_ - 1, end_);
     ++end_;
     // 方法1：需要1次构造以及1次析构，但该方法可能无法保证异常安全
-    *pos = move(value_type(forward<Args>(args)...));
+    *pos = hstl::move(value_type(hstl::forward<Args>(args)...));
     // 方法2：需要2次构造以及一次析构
-    value_type tmp(forward<Args>(args)...);
-    destroy_at(pos);
-    ::new (static_cast<void*>(pos)) value_type(move(tmp));
+    value_type tmp(hstl::forward<Args>(args)...);
+    hstl::destroy_at(pos);
+    ::new (static_cast<void*>(pos)) value_type(hstl::move(tmp));
 
     // 错误方法：需要类有swap函数
     // value_type(forward<Args>(args)...).swap(*pos);
     return pos;
   }
-  auto new_cap = get_new_capacity(capacity());
-  auto mem = capacity_.second().allocate(new_cap);
-  uninitialized_move(begin_, pos, mem);
-  ::new (static_cast<void*>(mem + (pos - begin_))) value_type(forward<Args>(args)...);
-  uninitialized_move(pos, end_, mem + (pos - begin_) + 1);
-
   auto offset = pos - begin_;
   auto s = size();
+  auto new_cap = get_new_capacity(s + 1);
+  auto mem = allocate_at_least(new_cap);
+  // 先构造新元素：args可能引用vector中的元素
+  ::new (static_cast<void*>(mem + offset)) value_type(hstl::forward<Args>(args)...);
+  hstl::uninitialized_relocate(begin_, pos, mem);
+  hstl::uninitialized_relocate(pos, end_, mem + offset + 1);
 
-  destroy(begin_, end_);
   capacity_.second().deallocate(begin_, capacity_.first() - begin_);
   
   begin_ = mem;
@@ -344,32 +416,30 @@ typename vector<T, Allocator>::iterator vector<T, Allocator>::do_insert(iterator
   return begin_ + offset;
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::do_insert_range(iterator position, size_type n, const value_type& value) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::do_insert_range(iterator position, size_type n, const value_type& value) {
   if (size() + n <= capacity()) {
-    if (n <= end_ - position) {
-      uninitialized_move(end_ - n, end_, end_);
+    if (n <= static_cast<size_type>(end_ - position)) {
+      hstl::uninitialized_move(end_ - n, end_, end_);
       std::move_backward(position, end_ - n, end_);
-      uninitialized_fill_n(position, n, value);
+      hstl::uninitialized_fill_n(position, n, value);
     } else {
-      uninitialized_move(position, end_, end_ + n);
-      destroy(position, end_);
-      uninitialized_fill_n(position, n, value);
+      hstl::uninitialized_move(position, end_, end_ + n);
+      hstl::destroy(position, end_);
+      hstl::uninitialized_fill_n(position, n, value);
     }
     return position;
   }
-  auto new_cap = get_new_capacity(capacity());
-  new_cap = new_cap < size() + n ? size() + n : new_cap;
-  auto mem = capacity_.second().allocate(new_cap);
+  auto new_cap = get_new_capacity(size() + n);
+  auto mem = allocate_at_least(new_cap);
 
-  uninitialized_move(begin_, position, mem);
-  uninitialized_fill_n(mem + (position - begin_), n, value);
-  uninitialized_move(position, end_, mem + (position - begin_) + n);
+  hstl::uninitialized_fill_n(mem + (position - begin_), n, value);
+  hstl::uninitialized_relocate(begin_, position, mem);
+  hstl::uninitialized_relocate(position, end_, mem + (position - begin_) + n);
 
   auto offset = position - begin_;
   auto s = size();
-  
-  destroy(begin_, end_);
+
   capacity_.second().deallocate(begin_, capacity_.first() - begin_);
 
   begin_ = mem;
@@ -379,93 +449,98 @@ typename vector<T, Allocator>::iterator vector<T, Allocator>::do_insert_range(it
   return begin_ + offset;
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::erase(const_iterator pos) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::erase(const_iterator pos) {
   return erase(pos, pos + 1);
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::erase(const_iterator first, const_iterator last) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::erase(const_iterator first, const_iterator last) {
   assert(first >= begin_ && last <= end_);
-  auto it1 = first;
-  for (auto it2 = last; it2 != end_; ++it1, ++it2) {
-    *it1 = *it2;
-  }
-  destory(it1, end_);
-  end_ = it1;
+  auto pos = const_cast<iterator>(first);
+  auto new_end = std::move(const_cast<iterator>(last), end_, pos);
+  hstl::destroy(new_end, end_);
+  end_ = new_end;
+  return pos;
 }
-template<typename T, typename Allocator>
-void vector<T, Allocator>::push_back( const T& value ) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::push_back( const T& value ) {
   do_insert_back(value);
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::push_back( T&& value ) {
-  do_insert_back(forward<T>(value));
+template <typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::push_back( T&& value ) {
+  do_insert_back(hstl::forward<T>(value));
 }
 
-template<typename T, typename Allocator>
+template <typename T, typename Allocator, typename GrowthPolicy>
 template <typename... Args>
-void vector<T, Allocator>::emplace_back(Args&&... args) {
-  do_insert_back(forward<Args>(args)...);
+void vector<T, Allocator, GrowthPolicy>::emplace_back(Args&&... args) {
+  do_insert_back(hstl::forward<Args>(args)...);
 }
 
-template<typename T, typename Allocator>
+template <typename T, typename Allocator, typename GrowthPolicy>
 template<typename... Args>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::do_insert_back(Args&&... args) {
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::do_insert_back(Args&&... args) {
   if (size() < capacity()) {
-    ::new (static_cast<void*>(end_)) T(forward<Args>(args)...);
+    ::new (static_cast<void*>(end_)) T(hstl::forward<Args>(args)...);
+    ++end_;
+  } else if constexpr (kReallocate) {
+    // args可能引用vector中的元素，realloc之后就失效了
+    value_type value(hstl::forward<Args>(args)...);
+    reallocate(get_new_capacity(size() + 1));
+    ::new (static_cast<void*>(end_)) value_type(hstl::move(value));
     ++end_;
   } else {
-    auto new_cap = get_new_capacity(capacity());
-    auto mem = capacity_.second().allocate(new_cap);
-    uninitialized_move(begin_, end_, mem);
-    auto s = size();
-    ::new (static_cast<void*>(mem + s)) value_type(forward<Args>(args)...);
-    destroy(begin_, end_);
-    capacity_.second().deallocate(begin_, capacity_.first() - begin_);
-    begin_ = mem;
-    end_ = begin_ + s + 1;
-    capacity_.first() = begin_ + new_cap;
+    auto new_cap = get_new_capacity(size() + 1);
+    auto mem = allocate_at_least(new_cap);
+    // 先构造新元素：args可能引用vector中的元素
+    ::new (static_cast<void*>(mem + size())) value_type(hstl::forward<Args>(args)...);
+    relocate_to(mem, new_cap);
+    ++end_;
   }
   return end_ - 1;
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::pop_back() {
-  destroy_at(--end_);
+template <typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::pop_back() {
+  hstl::destroy_at(--end_);
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::resize(size_type count, const value_type& value) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::resize(size_type count, const value_type& value) {
   if (count < size()) {
-    destroy(begin_ + count, end_);
+    hstl::destroy(begin_ + count, end_);
+    end_ = begin_ + count;
   } else if (count > size()) {
-    if (count > capacity()) {
-      auto new_cap = get_new_capacity(capacity());
-      auto mem = capacity_.second().allocate(new_cap);
-      uninitialized_move(begin_, end_, mem);
-      uninitialized_fill_n(mem + size(), count - size(), value);
-      destory(begin_, end_);
-      begin_ = mem;
+    if (count > capacity() && kReallocate) {
+      // value可能引用vector中的元素
+      value_type copy(value);
+      reallocate(get_new_capacity(count));
+      hstl::uninitialized_fill_n(end_, count - size(), copy);
+      end_ = begin_ + count;
+    } else if (count > capacity()) {
+      auto new_cap = get_new_capacity(count);
+      auto mem = allocate_at_least(new_cap);
+      hstl::uninitialized_fill_n(mem + size(), count - size(), value);
+      relocate_to(mem, new_cap);
       end_ = begin_ + count;
-      capacity_.first() = begin_ + new_cap;
     } else {
-      uninitialized_fill_n(end_, count - size(), value);
+      hstl::uninitialized_fill_n(end_, count - size(), value);
       end_ = begin_ + count;
     }
   }
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::swap(vector& other) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::swap(vector& other) {
   std::swap(begin_, other.begin_);
   std::swap(end_, other.end_);
   std::swap(capacity_, other.capacity_);
 }
 
-template<typename T, typename Allocator>
-void swap(vector<T, Allocator>& lhs, vector<T, Allocator>& rhs) {
+template <typename T, typename Allocator, typename GrowthPolicy>
+void swap(vector<T, Allocator, GrowthPolicy>& lhs, vector<T, Allocator, GrowthPolicy>& rhs) {
   lhs.swap(rhs);
 }
 
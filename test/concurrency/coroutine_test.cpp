@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "concurrency/coroutine.hpp"
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+hstl::task<int> answer() { co_return 42; }
+
+hstl::task<std::thread::id> worker_id(hstl::ThreadPool& pool) {
+  co_await pool.schedule();
+  co_return std::this_thread::get_id();
+}
+
+hstl::task<int> add(hstl::ThreadPool& pool, int a, int b) {
+  co_await pool.schedule();
+  int x = co_await answer();
+  co_return a + b + x - 42;
+}
+
+hstl::task<void> fail(hstl::ThreadPool& pool) {
+  co_await pool.schedule();
+  throw std::runtime_error("fail");
+}
+
+}  // namespace
+
+TEST(CoroutineTest, SyncWait) {
+  EXPECT_EQ(hstl::sync_wait(answer()), 42);
+
+  hstl::ThreadPool pool(2);
+  EXPECT_NE(hstl::sync_wait(worker_id(pool)), std::this_thread::get_id());
+  EXPECT_EQ(hstl::sync_wait(add(pool, 1, 2)), 3);
+  EXPECT_THROW(hstl::sync_wait(fail(pool)), std::runtime_error);
+}
+
+TEST(CoroutineTest, AwaitTask) {
+  hstl::ThreadPool pool(2);
+  auto outer = [](hstl::ThreadPool& pool) -> hstl::task<std::string> {
+    auto t = add(pool, 2, 3);
+    int& ref = co_await t;
+    int moved = co_await add(pool, ref, 1);
+    try {
+      co_await fail(pool);
+    } catch (const std::runtime_error&) {
+      co_return "caught " + std::to_string(moved);
+    }
+    co_return "not caught";
+  };
+  EXPECT_EQ(hstl::sync_wait(outer(pool)), "caught 6");
+}
+
+TEST(CoroutineTest, LazyAndMoveOnly) {
+  hstl::ThreadPool pool(1);
+  bool started = false;
+  auto t = [](bool& started) -> hstl::task<std::unique_ptr<int>> {
+    started = true;
+    co_return std::make_unique<int>(7);
+  }(started);
+  EXPECT_FALSE(started);
+  EXPECT_FALSE(t.is_ready());
+  auto p = hstl::sync_wait(std::move(t));
+  EXPECT_TRUE(started);
+  EXPECT_EQ(*p, 7);
+
+  // destroying a task which never ran destroys its frame
+  auto never = add(pool, 1, 1);
+}
+
+TEST(CoroutineTest, WhenAll) {
+  hstl::ThreadPool pool(4);
+  // many tasks in flight at once, none of them blocks a thread
+  std::vector<hstl::task<int>> tasks;
+  for (int i = 0; i < 10000; ++i) {
+    tasks.push_back(add(pool, i, 1));
+  }
+  auto results = hstl::sync_wait(hstl::when_all(std::move(tasks)));
+  ASSERT_EQ(results.size(), 10000u);
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_EQ(results[i], i + 1);
+  }
+
+  std::atomic<int> count{0};
+  auto bump = [](hstl::ThreadPool& pool, std::atomic<int>& count) -> hstl::task<void> {
+    co_await pool.schedule(hstl::Priority::high);
+    count++;
+  };
+  std::vector<hstl::task<void>> voids;
+  for (int i = 0; i < 100; ++i) {
+    voids.push_back(bump(pool, count));
+  }
+  voids.push_back(fail(pool));
+  EXPECT_THROW(hstl::sync_wait(hstl::when_all(std::move(voids))), std::runtime_error);
+  EXPECT_EQ(count.load(), 100);
+
+  EXPECT_TRUE(hstl::sync_wait(hstl::when_all(std::vector<hstl::task<int>>())).empty());
+}
+
+TEST(CoroutineTest, ScheduleOnDeadPool) {
+  auto pool = std::make_unique<hstl::ThreadPool>(1);
+  std::promise<void> started;
+  std::promise<void> gate;
+  pool->post(hstl::TaskNode::create([&started, f = gate.get_future().share()]() {
+    started.set_value();
+    f.wait();
+  }));
+  started.get_future().wait();
+
+  // queued behind the blocked worker, discarded by shutdown_now()
+  std::atomic<bool> caught{false};
+  auto t = [](hstl::ThreadPool& pool, std::atomic<bool>& caught) -> hstl::task<void> {
+    try {
+      co_await pool.schedule();
+    } catch (const std::future_error&) {
+      caught = true;
+    }
+  }(*pool, caught);
+  std::thread driver([&t]() { hstl::sync_wait(std::move(t)); });
+  while (pool->outstanding() < 2) {
+    std::this_thread::yield();
+  }
+  std::thread releaser([&gate]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    gate.set_value();
+  });
+  pool->shutdown_now();
+  releaser.join();
+  driver.join();
+  EXPECT_TRUE(caught.load());
+}
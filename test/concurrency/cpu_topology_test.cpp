@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "concurrency/cpu_topology.hpp"
+
+TEST(CpuTopologyTest, ParseCpulist) {
+  EXPECT_EQ(hstl::CpuTopology::parse_cpulist("0-3,8,10-11"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(hstl::CpuTopology::parse_cpulist("5"), (std::vector<int>{5}));
+  EXPECT_EQ(hstl::CpuTopology::parse_cpulist(""), (std::vector<int>{}));
+  EXPECT_EQ(hstl::CpuTopology::parse_cpulist("1,,x,2"), (std::vector<int>{1, 2}));
+}
+
+TEST(CpuTopologyTest, Detect) {
+  auto topology = hstl::CpuTopology::detect();
+  ASSERT_FALSE(topology.cpus.empty());
+  ASSERT_EQ(topology.cpus.size(), topology.nodes.size());
+  EXPECT_TRUE(std::is_sorted(topology.nodes.begin(), topology.nodes.end()));
+
+  // only CPUs the process may run on
+  auto allowed = hstl::CpuTopology::allowed_cpus();
+  for (int cpu : topology.cpus) {
+    EXPECT_NE(std::find(allowed.begin(), allowed.end(), cpu), allowed.end());
+  }
+  EXPECT_EQ(topology.node_of(topology.cpus[0]), topology.nodes[0]);
+  EXPECT_EQ(topology.node_of(-1), 0);
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "concurrency/error_ring.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int value_of(const std::exception_ptr& error) {
+  try {
+    std::rethrow_exception(error);
+  } catch (const std::runtime_error& e) {
+    return std::stoi(e.what());
+  }
+}
+
+}  // namespace
+
+TEST(ErrorRingTest, FifoAndDropWhenFull) {
+  hstl::ErrorRing ring(3);
+  EXPECT_EQ(ring.capacity(), 4u);
+  std::exception_ptr error;
+  EXPECT_FALSE(ring.pop(error));
+
+  for (int i = 0; i < 6; i++) {
+    EXPECT_EQ(ring.push(std::make_exception_ptr(std::runtime_error(std::to_string(i)))), i < 4);
+  }
+  EXPECT_EQ(ring.dropped(), 2u);
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(ring.pop(error));
+    EXPECT_EQ(value_of(error), i);
+  }
+  EXPECT_FALSE(ring.pop(error));
+
+  // the slots are reused after a wrap
+  EXPECT_TRUE(ring.push(std::make_exception_ptr(std::runtime_error("7"))));
+  ASSERT_TRUE(ring.pop(error));
+  EXPECT_EQ(value_of(error), 7);
+}
+
+TEST(ErrorRingTest, ConcurrentProducers) {
+  hstl::ErrorRing ring(64);
+  const int producer_count = 4;
+  const int per_producer = 10000;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < producer_count; p++) {
+    producers.emplace_back([&ring, p]() {
+      for (int i = 0; i < per_producer; i++) {
+        ring.push(std::make_exception_ptr(std::runtime_error(std::to_string(p))));
+      }
+    });
+  }
+
+  // drain while the producers run, every error is either popped or dropped
+  std::vector<int> popped(producer_count, 0);
+  std::exception_ptr error;
+  auto drain = [&]() {
+    while (ring.pop(error)) {
+      popped[value_of(error)]++;
+    }
+  };
+  for (int i = 0; i < 1000; i++) {
+    drain();
+    std::this_thread::yield();
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  drain();
+
+  int total = 0;
+  for (int n : popped) {
+    total += n;
+  }
+  EXPECT_EQ(total + ring.dropped(), static_cast<uint64_t>(producer_count * per_producer));
+}
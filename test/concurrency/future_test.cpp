@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrency/future.hpp"
+#include "concurrency/thread_pool.h"
+
+TEST(FutureTest, PromiseSetValue) {
+  hstl::promise<int> p;
+  auto f = p.get_future();
+  ASSERT_FALSE(f.is_ready());
+
+  std::thread t([&p]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    p.set_value(42);
+  });
+  ASSERT_EQ(f.get(), 42);
+  ASSERT_FALSE(f.valid());
+  t.join();
+}
+
+TEST(FutureTest, ExceptionAndBrokenPromise) {
+  hstl::promise<int> p;
+  auto f = p.get_future();
+  p.set_exception(std::make_exception_ptr(std::runtime_error("Test exception")));
+  ASSERT_THROW(f.get(), std::runtime_error);
+
+  hstl::future<void> f2;
+  {
+    hstl::promise<void> p2;
+    f2 = p2.get_future();
+  }
+  ASSERT_THROW(f2.get(), std::future_error);
+}
+
+TEST(FutureTest, AsyncThen) {
+  hstl::ThreadPool pool(2);
+
+  auto f = pool.async([](int a, int b) { return a + b; }, 1, 2)
+               .then([](int v) { return std::to_string(v); })
+               .then([](std::string s) { return s + "!"; });
+  ASSERT_EQ(f.get(), "3!");
+
+  // the exception skips the continuation
+  std::atomic<bool> called(false);
+  auto f2 = pool.async([]() -> int { throw std::runtime_error("Test exception"); })
+                .then([&called](int v) {
+                  called = true;
+                  return v;
+                });
+  ASSERT_THROW(f2.get(), std::runtime_error);
+  ASSERT_FALSE(called.load());
+}
+
+TEST(FutureTest, ThenOnReadyFuture) {
+  hstl::ThreadPool pool(1);
+  hstl::promise<int> p(&pool);
+  auto f = p.get_future();
+  p.set_value(1);
+  ASSERT_EQ(f.then([](int v) { return v + 1; }).get(), 2);
+}
+
+TEST(FutureTest, WhenAll) {
+  hstl::ThreadPool pool(4);
+  std::vector<hstl::future<int>> futures;
+  for (int i = 0; i < 100; i++) {
+    futures.push_back(pool.async([i]() { return i * i; }));
+  }
+  auto all = hstl::when_all(futures).get();
+  ASSERT_EQ(all.size(), 100);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(all[i], i * i);
+  }
+
+  std::atomic<int> counter(0);
+  std::vector<hstl::future<void>> voids;
+  for (int i = 0; i < 100; i++) {
+    voids.push_back(pool.async([&counter]() { counter++; }));
+  }
+  hstl::when_all(voids).get();
+  ASSERT_EQ(counter.load(), 100);
+
+  std::vector<hstl::future<int>> none;
+  ASSERT_TRUE(hstl::when_all(none).get().empty());
+}
+
+TEST(FutureTest, WhenAllException) {
+  hstl::ThreadPool pool(2);
+  std::vector<hstl::future<int>> futures;
+  futures.push_back(pool.async([]() { return 1; }));
+  futures.push_back(pool.async([]() -> int { throw std::runtime_error("Test exception"); }));
+  ASSERT_THROW(hstl::when_all(futures).get(), std::runtime_error);
+}
+
+TEST(FutureTest, WhenAny) {
+  hstl::ThreadPool pool(2);
+  hstl::promise<int> never;
+  std::vector<hstl::future<int>> futures;
+  futures.push_back(never.get_future());
+  futures.push_back(pool.async([]() { return 7; }));
+
+  auto [index, value] = hstl::when_any(futures).get();
+  ASSERT_EQ(index, 1);
+  ASSERT_EQ(value, 7);
+  never.set_value(0);
+}
+
+TEST(FutureTest, FanOutFanIn) {
+  hstl::ThreadPool pool(4);
+  // continuations chain on the pool without any thread blocking in between
+  auto root = pool.async([]() { return 1; });
+  std::vector<hstl::future<int>> branches;
+  auto shared = root.then([](int v) { return v * 10; });
+  int base = shared.get();
+  for (int i = 0; i < 10; i++) {
+    branches.push_back(pool.async([base, i]() { return base + i; }).then([](int v) { return v * 2; }));
+  }
+  auto sum = hstl::when_all(branches).then([](std::vector<int> v) {
+    int s = 0;
+    for (int x : v) {
+      s += x;
+    }
+    return s;
+  });
+  ASSERT_EQ(sum.get(), 2 * (10 * 10 + 45));
+}
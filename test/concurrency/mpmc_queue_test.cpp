@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include "concurrency/mpmc_queue.hpp"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+TEST(MpmcQueueTest, TryPushPop) {
+  hstl::MpmcQueue<int> queue(3);
+  EXPECT_EQ(queue.capacity(), 4u);
+  int value = 0;
+  EXPECT_FALSE(queue.try_pop(value));
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(queue.try_push(i));
+  }
+  EXPECT_FALSE(queue.try_push(4));
+  EXPECT_EQ(queue.size_approx(), 4u);
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(queue.try_pop(value));
+}
+
+TEST(MpmcQueueTest, Batch) {
+  hstl::MpmcQueue<int> queue(8);
+  std::vector<int> in = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  EXPECT_EQ(queue.try_push_n(in.begin(), in.size()), 8u);
+  std::vector<int> out;
+  EXPECT_EQ(queue.try_pop_n(std::back_inserter(out), 5), 5u);
+  EXPECT_EQ(queue.try_push_n(in.begin() + 8, 2), 2u);
+  EXPECT_EQ(queue.try_pop_n(std::back_inserter(out), 100), 5u);
+  EXPECT_EQ(out, in);
+  EXPECT_EQ(queue.try_pop_n(std::back_inserter(out), 100), 0u);
+}
+
+TEST(MpmcQueueTest, MoveOnlyAndDestroysLeftovers) {
+  auto counter = std::make_shared<int>(0);
+  {
+    hstl::MpmcQueue<std::shared_ptr<int>> queue(4);
+    queue.push(counter);
+    queue.push(counter);
+    std::shared_ptr<int> out;
+    queue.pop(out);
+    EXPECT_EQ(counter.use_count(), 3);
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+
+  hstl::MpmcQueue<std::unique_ptr<int>> queue(2);
+  queue.push(std::make_unique<int>(7));
+  std::unique_ptr<int> out;
+  ASSERT_TRUE(queue.try_pop(out));
+  EXPECT_EQ(*out, 7);
+}
+
+TEST(MpmcQueueTest, BlockingProducersConsumers) {
+  // a small ring, so that both sides block often
+  hstl::MpmcQueue<int> queue(16);
+  const int producer_count = 4;
+  const int consumer_count = 4;
+  const int per_producer = 50000;
+  std::atomic<long> sum{0};
+  std::atomic<int> popped{0};
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producer_count; p++) {
+    threads.emplace_back([&queue, p]() {
+      std::vector<int> batch;
+      for (int i = 1; i <= per_producer; i++) {
+        // every producer mixes single and batch pushes
+        if (p % 2 == 0) {
+          queue.push(i);
+        } else {
+          batch.push_back(i);
+          if (batch.size() == 7 || i == per_producer) {
+            queue.push_n(batch.begin(), batch.size());
+            batch.clear();
+          }
+        }
+      }
+    });
+  }
+  for (int c = 0; c < consumer_count; c++) {
+    threads.emplace_back([&, c]() {
+      const int total = producer_count * per_producer;
+      std::vector<int> out;
+      while (popped.load() < total) {
+        out.clear();
+        if (c % 2 == 0) {
+          int value;
+          if (!queue.try_pop(value)) {
+            std::this_thread::yield();
+            continue;
+          }
+          out.push_back(value);
+        } else {
+          queue.try_pop_n(std::back_inserter(out), 5);
+        }
+        for (int v : out) {
+          sum += v;
+        }
+        popped += static_cast<int>(out.size());
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(popped.load(), producer_count * per_producer);
+  EXPECT_EQ(sum.load(), static_cast<long>(producer_count) * per_producer * (per_producer + 1) / 2);
+}
+
+TEST(MpmcQueueTest, BlockingPopWakesUp) {
+  hstl::MpmcQueue<int> queue(4);
+  std::vector<std::thread> consumers;
+  std::atomic<int> sum{0};
+  for (int c = 0; c < 3; c++) {
+    consumers.emplace_back([&]() {
+      std::vector<int> out;
+      queue.pop_n(std::back_inserter(out), 1);
+      sum += out[0];
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  for (int i = 1; i <= 3; i++) {
+    queue.push(i);
+  }
+  for (auto& t : consumers) {
+    t.join();
+  }
+  EXPECT_EQ(sum.load(), 6);
+}
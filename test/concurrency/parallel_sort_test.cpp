@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "concurrency/parallel_sort.hpp"
+#include "vector.hpp"
+
+template <typename T>
+static std::vector<T> random_values(size_t n, uint64_t seed) {
+  std::mt19937_64 gen(seed);
+  std::vector<T> v(n);
+  for (auto &x : v) {
+    x = static_cast<T>(gen());
+  }
+  return v;
+}
+
+TEST(ParallelSortTest, Integers) {
+  hstl::ThreadPool pool(4);
+
+  for (size_t n : {0, 1, 2, 17, 1000, 20000, 300000}) {
+    auto a = random_values<int32_t>(n, n);
+    auto expected = a;
+    std::sort(expected.begin(), expected.end());
+    hstl::parallel_sort(pool, a.begin(), a.end());
+    ASSERT_EQ(a, expected) << n;
+
+    auto b = random_values<uint64_t>(n, n + 1);
+    auto expected_b = b;
+    std::sort(expected_b.begin(), expected_b.end());
+    hstl::parallel_sort(pool, b);
+    ASSERT_EQ(b, expected_b) << n;
+  }
+
+  // small keys, most radix passes are skipped
+  std::vector<int64_t> small(100000);
+  for (size_t i = 0; i < small.size(); ++i) {
+    small[i] = static_cast<int64_t>(i % 7) - 3;
+  }
+  hstl::parallel_sort(pool, small);
+  EXPECT_TRUE(std::is_sorted(small.begin(), small.end()));
+}
+
+TEST(ParallelSortTest, Comparator) {
+  hstl::ThreadPool pool(4);
+
+  auto a = random_values<int>(100000, 1);
+  hstl::parallel_sort(pool, a.begin(), a.end(), std::greater<>());
+  EXPECT_TRUE(std::is_sorted(a.begin(), a.end(), std::greater<>()));
+
+  auto d = random_values<int64_t>(100000, 2);
+  std::vector<double> doubles(d.begin(), d.end());
+  auto expected = doubles;
+  std::sort(expected.begin(), expected.end());
+  hstl::parallel_sort(pool, doubles.begin(), doubles.end());
+  EXPECT_EQ(doubles, expected);
+}
+
+TEST(ParallelSortTest, Duplicates) {
+  hstl::ThreadPool pool(4);
+
+  std::vector<double> same(50000, 1.5);
+  hstl::parallel_sort(pool, same);
+  EXPECT_EQ(same, std::vector<double>(50000, 1.5));
+
+  std::vector<double> few(100000);
+  for (size_t i = 0; i < few.size(); ++i) {
+    few[i] = static_cast<double>((i * 7919) % 3);
+  }
+  hstl::parallel_sort(pool, few);
+  EXPECT_TRUE(std::is_sorted(few.begin(), few.end()));
+  EXPECT_EQ(std::count(few.begin(), few.end(), 2.0), 33333);
+}
+
+TEST(ParallelSortTest, NonTrivialTypes) {
+  hstl::ThreadPool pool(4);
+
+  auto keys = random_values<uint32_t>(50000, 3);
+  std::vector<std::string> strings;
+  for (auto k : keys) {
+    strings.push_back(std::to_string(k));
+  }
+  auto expected = strings;
+  std::sort(expected.begin(), expected.end());
+  hstl::parallel_sort(pool, strings);
+  EXPECT_EQ(strings, expected);
+
+  // move only
+  std::vector<std::unique_ptr<int>> ptrs;
+  for (auto k : keys) {
+    ptrs.push_back(std::make_unique<int>(k));
+  }
+  hstl::parallel_sort(pool, ptrs.begin(), ptrs.end(),
+                      [](const auto &a, const auto &b) { return *a < *b; });
+  EXPECT_TRUE(std::is_sorted(ptrs.begin(), ptrs.end(),
+                             [](const auto &a, const auto &b) { return *a < *b; }));
+}
+
+TEST(ParallelSortTest, HstlVector) {
+  hstl::ThreadPool pool(2);
+
+  auto values = random_values<int16_t>(100000, 4);
+  hstl::vector<int16_t> v(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    v[i] = values[i];
+  }
+  hstl::parallel_sort(pool, v);
+  std::sort(values.begin(), values.end());
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(v[i], values[i]);
+  }
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "concurrency/parallel.hpp"
+#include "vector.hpp"
+
+TEST(ParallelTest, ParallelFor) {
+  hstl::ThreadPool pool(4);
+
+  std::vector<int> hits(100000, 0);
+  hstl::parallel_for(pool, 0, 100000, [&hits](int i) { hits[i]++; });
+  for (int h : hits) {
+    ASSERT_EQ(h, 1);
+  }
+
+  // empty and tiny ranges
+  std::atomic<int> counter(0);
+  hstl::parallel_for(pool, 5, 5, [&counter](int) { counter++; });
+  hstl::parallel_for(pool, size_t(0), size_t(1), [&counter](size_t) { counter++; });
+  EXPECT_EQ(counter.load(), 1);
+}
+
+TEST(ParallelTest, ParallelForElements) {
+  hstl::ThreadPool pool(4);
+
+  hstl::vector<int> v(1000);
+  for (size_t i = 0; i < v.size(); ++i) {
+    v[i] = i;
+  }
+  hstl::parallel_for(pool, v, [](int &x) { x *= 2; });
+  for (size_t i = 0; i < v.size(); ++i) {
+    ASSERT_EQ(v[i], 2 * i);
+  }
+
+  int raw[64] = {};
+  hstl::parallel_for(pool, raw, raw + 64, [](int &x) { x = 7; }, 4);
+  for (int x : raw) {
+    ASSERT_EQ(x, 7);
+  }
+}
+
+TEST(ParallelTest, ParallelReduce) {
+  hstl::ThreadPool pool(4);
+
+  std::vector<long long> v(100001);
+  std::iota(v.begin(), v.end(), 0);
+  EXPECT_EQ(hstl::parallel_reduce(pool, v.begin(), v.end(), 0LL), 100000LL * 100001 / 2);
+  EXPECT_EQ(hstl::parallel_reduce(pool, v, 1LL), 100000LL * 100001 / 2 + 1);
+  EXPECT_EQ(hstl::parallel_reduce(pool, v.begin(), v.begin(), 42LL), 42);
+
+  // associative but not commutative, the order must be kept
+  std::vector<std::string> words(1000);
+  std::string expected = ">";
+  for (size_t i = 0; i < words.size(); ++i) {
+    words[i] = std::to_string(i % 10);
+    expected += words[i];
+  }
+  EXPECT_EQ(hstl::parallel_reduce(pool, words.begin(), words.end(), std::string(">"),
+                                  [](std::string a, const std::string &b) { return a + b; }, 7),
+            expected);
+}
+
+TEST(ParallelTest, ParallelTransform) {
+  hstl::ThreadPool pool(4);
+
+  hstl::vector<int> in(10000);
+  for (size_t i = 0; i < in.size(); ++i) {
+    in[i] = i;
+  }
+  std::vector<double> out(in.size());
+  auto end = hstl::parallel_transform(pool, in.begin(), in.end(), out.begin(),
+                                      [](int x) { return x * 0.5; });
+  EXPECT_EQ(end, out.end());
+  for (size_t i = 0; i < out.size(); ++i) {
+    ASSERT_EQ(out[i], i * 0.5);
+  }
+}
+
+TEST(ParallelTest, ParallelInclusiveScan) {
+  hstl::ThreadPool pool(4);
+
+  for (size_t n : {0, 1, 2, 15, 16, 17, 1000, 100003}) {
+    std::vector<long long> in(n);
+    std::iota(in.begin(), in.end(), 1);
+    std::vector<long long> expected(n);
+    std::partial_sum(in.begin(), in.end(), expected.begin());
+
+    std::vector<long long> out(n);
+    auto end = hstl::parallel_inclusive_scan(pool, in.begin(), in.end(), out.begin());
+    EXPECT_EQ(end, out.end());
+    EXPECT_EQ(out, expected);
+
+    // in place
+    hstl::parallel_inclusive_scan(pool, in.begin(), in.end(), in.begin(), std::plus<>(), 3);
+    EXPECT_EQ(in, expected);
+  }
+}
+
+TEST(ParallelTest, Exception) {
+  hstl::ThreadPool pool(4);
+
+  std::atomic<int> counter(0);
+  EXPECT_THROW(hstl::parallel_for(pool, 0, 10000, [&counter](int i) {
+                 counter++;
+                 if (i == 5000) {
+                   throw std::runtime_error("Test exception");
+                 }
+               }, 16),
+               std::runtime_error);
+  EXPECT_LE(counter.load(), 10000);
+
+  // the pool is still usable
+  EXPECT_EQ(hstl::parallel_reduce(pool, std::vector<int>(100, 1), 0), 100);
+}
+
+TEST(ParallelTest, Nested) {
+  hstl::ThreadPool pool(2);
+
+  // every worker may be busy waiting for an inner loop, they must help instead of blocking
+  std::atomic<int> counter(0);
+  hstl::parallel_for(pool, 0, 16, [&](int) {
+    hstl::parallel_for(pool, 0, 1000, [&counter](int) { counter++; });
+  }, 1);
+  EXPECT_EQ(counter.load(), 16000);
+
+  auto f = pool.submit([&pool]() {
+    return hstl::parallel_reduce(pool, std::vector<int>(1000, 2), 0);
+  });
+  EXPECT_EQ(f.get(), 2000);
+}
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include "concurrency/ring_buffer.hpp"
+
+#include <deque>
+#include <random>
+
+TEST(RingBufferTest, BothEnds) {
+  hstl::RingBuffer<int> ring;
+  EXPECT_TRUE(ring.empty());
+  for (int i = 0; i < 5; i++) {
+    ring.push_back(i);
+  }
+  EXPECT_EQ(ring.size(), 5u);
+  EXPECT_EQ(ring.front(), 0);
+  EXPECT_EQ(ring.back(), 4);
+  EXPECT_EQ(ring.pop_front(), 0);
+  EXPECT_EQ(ring.pop_back(), 4);
+  EXPECT_EQ(ring[0], 1);
+  EXPECT_EQ(ring[2], 3);
+  ring.clear();
+  EXPECT_TRUE(ring.empty());
+}
+
+TEST(RingBufferTest, ReserveAndWrap) {
+  hstl::RingBuffer<int> ring;
+  ring.reserve(100);
+  EXPECT_EQ(ring.capacity(), 128u);
+
+  // wraps around without growing, then grows in the middle of a wrap
+  std::deque<int> expected;
+  std::mt19937 rng(7);
+  for (int i = 0; i < 100000; i++) {
+    if (expected.size() < 100 && rng() % 3 != 0) {
+      ring.push_back(i);
+      expected.push_back(i);
+    } else if (!expected.empty()) {
+      ASSERT_EQ(ring.pop_front(), expected.front());
+      expected.pop_front();
+    }
+  }
+  EXPECT_EQ(ring.capacity(), 128u);
+  for (int i = 0; i < 200; i++) {
+    ring.push_back(i);
+    expected.push_back(i);
+  }
+  EXPECT_EQ(ring.capacity(), 512u);
+  ASSERT_EQ(ring.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    ASSERT_EQ(ring[i], expected[i]);
+  }
+}
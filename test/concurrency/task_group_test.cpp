@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "concurrency/task_group.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+long fib(hstl::ThreadPool& pool, int n) {
+  if (n < 2) {
+    return n;
+  }
+  long a = 0;
+  hstl::task_group group(pool);
+  group.run([&pool, &a, n]() { a = fib(pool, n - 1); });
+  long b = fib(pool, n - 2);
+  group.wait();
+  return a + b;
+}
+
+}  // namespace
+
+TEST(TaskGroupTest, RunAndWait) {
+  hstl::ThreadPool pool(4);
+  hstl::task_group group(pool);
+  std::atomic<int> count{0};
+  for (int i = 0; i < 1000; i++) {
+    group.run([&count]() { count++; });
+  }
+  EXPECT_EQ(group.wait(), hstl::task_group_status::complete);
+  EXPECT_EQ(count.load(), 1000);
+
+  // reusable after wait
+  group.run([&count]() { count++; });
+  group.wait();
+  EXPECT_EQ(count.load(), 1001);
+}
+
+TEST(TaskGroupTest, NestedWaitOnOneWorker) {
+  // every level waits on the only worker, which helps instead of blocking
+  hstl::ThreadPool pool(1);
+  auto res = pool.submit([&pool]() { return fib(pool, 18); });
+  ASSERT_EQ(res.wait_for(std::chrono::seconds(30)), std::future_status::ready);
+  EXPECT_EQ(res.get(), 2584);
+}
+
+TEST(TaskGroupTest, CancelSkipsPendingTasks) {
+  hstl::ThreadPool pool(1);
+  std::promise<void> gate;
+  std::shared_future<void> opened = gate.get_future().share();
+  hstl::task_group group(pool);
+  std::atomic<int> ran{0};
+  std::atomic<bool> saw_cancel{false};
+  // occupies the worker until the gate opens, then sees the cancellation
+  group.run([&, opened](hstl::cancellation_token token) {
+    opened.wait();
+    saw_cancel = token.is_cancelled();
+    ran++;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  for (int i = 0; i < 100; i++) {
+    group.run([&ran]() { ran++; });
+  }
+  group.cancel();
+  EXPECT_TRUE(group.token().is_cancelled());
+  gate.set_value();
+  EXPECT_EQ(group.wait(), hstl::task_group_status::canceled);
+  EXPECT_TRUE(saw_cancel.load());
+  // only the running task, unless wait() got to it before the worker
+  EXPECT_LE(ran.load(), 1);
+  EXPECT_FALSE(group.is_cancelled());
+  EXPECT_FALSE(hstl::cancellation_token().is_cancelled());
+}
+
+TEST(TaskGroupTest, ExceptionCancelsGroup) {
+  hstl::ThreadPool pool(2);
+  hstl::task_group group(pool);
+  std::atomic<int> ran{0};
+  group.run([]() { throw std::runtime_error("Test exception"); });
+  for (int i = 0; i < 1000; i++) {
+    group.run([&ran]() {
+      std::this_thread::sleep_for(std::chrono::microseconds(10));
+      ran++;
+    });
+  }
+  EXPECT_THROW(group.wait(), std::runtime_error);
+  EXPECT_LT(ran.load(), 1000);
+
+  // the error is gone after wait
+  group.run([&ran]() { ran++; });
+  EXPECT_EQ(group.wait(), hstl::task_group_status::complete);
+}
+
+TEST(TaskGroupTest, DiscardedByShutdown) {
+  auto pool = std::make_unique<hstl::ThreadPool>(1);
+  std::promise<void> started;
+  std::promise<void> gate;
+  pool->post(hstl::TaskNode::create([&started, f = gate.get_future().share()]() {
+    started.set_value();
+    f.wait();
+  }));
+  started.get_future().wait();
+
+  hstl::task_group group(*pool);
+  std::atomic<bool> ran{false};
+  group.run([&ran]() { ran = true; });
+  std::thread releaser([&gate]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    gate.set_value();
+  });
+  pool->shutdown_now();
+  releaser.join();
+  EXPECT_THROW(group.wait(), std::future_error);
+  EXPECT_FALSE(ran.load());
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <thread>
+
+#include "concurrency/small_object_pool.hpp"
+#include "concurrency/task_node.hpp"
+#include "concurrency/thread_pool.h"
+
+struct Tracked {
+  static int alive;
+  int *runs;
+  explicit Tracked(int *r) : runs(r) { ++alive; }
+  Tracked(const Tracked &o) : runs(o.runs) { ++alive; }
+  ~Tracked() { --alive; }
+  void operator()() { ++*runs; }
+};
+int Tracked::alive = 0;
+
+TEST(TaskNodeTest, RunAndDiscard) {
+  int runs = 0;
+  hstl::TaskNode *a = hstl::TaskNode::create(Tracked(&runs));
+  hstl::TaskNode *b = hstl::TaskNode::create(Tracked(&runs));
+  ASSERT_EQ(Tracked::alive, 2);
+
+  a->run();
+  ASSERT_EQ(runs, 1);
+  ASSERT_EQ(Tracked::alive, 1);
+
+  // discard destroys the callable without running it
+  b->discard();
+  ASSERT_EQ(runs, 1);
+  ASSERT_EQ(Tracked::alive, 0);
+}
+
+TEST(TaskNodeTest, MoveOnlyAndBigCallable) {
+  auto p = std::make_unique<int>(1);
+  int result = 0;
+  hstl::TaskNode::create([p = std::move(p), &result]() { result += *p; })->run();
+  ASSERT_EQ(result, 1);
+
+  // does not fit into the node, stored out of line
+  std::array<int, 100> big{};
+  big[99] = 2;
+  hstl::TaskNode::create([big, &result]() { result += big[99]; })->run();
+  ASSERT_EQ(result, 3);
+
+  // over-aligned, stored out of line with its alignment
+  struct alignas(64) Aligned {
+    int *result;
+    void operator()() {
+      *result += reinterpret_cast<uintptr_t>(this) % alignof(Aligned) == 0 ? 4 : 100;
+    }
+  };
+  hstl::TaskNode::create(Aligned{&result})->run();
+  ASSERT_EQ(result, 7);
+}
+
+TEST(TaskNodeTest, ExceptionReleasesCallable) {
+  int runs = 0;
+  hstl::TaskNode *t = hstl::TaskNode::create([tracked = Tracked(&runs)]() {
+    throw std::runtime_error("Test exception");
+  });
+  ASSERT_THROW(t->run(), std::runtime_error);
+  ASSERT_EQ(Tracked::alive, 0);
+}
+
+TEST(SmallObjectPoolTest, ReuseAcrossThreads) {
+  // blocks allocated on one thread and freed on another go back through the depot
+  std::vector<void *> blocks;
+  for (int i = 0; i < 1000; i++) {
+    blocks.push_back(hstl::SmallObjectPool::allocate(64));
+  }
+  std::thread([&blocks]() {
+    for (auto p : blocks) {
+      hstl::SmallObjectPool::deallocate(p, 64);
+    }
+  }).join();
+
+  for (int i = 0; i < 1000; i++) {
+    blocks[i] = hstl::SmallObjectPool::allocate(64);
+  }
+  for (auto p : blocks) {
+    hstl::SmallObjectPool::deallocate(p, 64);
+  }
+}
+
+TEST(SmallObjectPoolTest, PromiseAllocator) {
+  std::promise<int> promise(std::allocator_arg, hstl::pool_allocator<char>());
+  auto future = promise.get_future();
+  std::thread([&promise]() { promise.set_value(42); }).join();
+  ASSERT_EQ(future.get(), 42);
+}
+
+// Destroyed after main() returns, after the thread_locals of the main thread (and so its pool
+// cache), and discards its queued tasks on the main thread.
+hstl::ThreadPool exit_pool(1);
+
+TEST(SmallObjectPoolTest, FreeAfterThreadExit) {
+  // another thread hands task node blocks over to the depot, so that the depot is in use
+  std::vector<void *> blocks;
+  for (int i = 0; i < 1000; i++) {
+    blocks.push_back(hstl::SmallObjectPool::allocate(sizeof(hstl::TaskNode)));
+  }
+  std::thread([&blocks]() {
+    for (auto p : blocks) {
+      hstl::SmallObjectPool::deallocate(p, sizeof(hstl::TaskNode));
+    }
+  }).join();
+
+  // keeps the worker busy until the pool is being shut down, so the tasks below are still
+  // queued when ~ThreadPool discards them
+  exit_pool.post(hstl::TaskNode::create([]() {
+    while (!exit_pool.is_closed()) {
+      std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }));
+  for (int i = 0; i < 100; i++) {
+    exit_pool.submit([]() {});
+  }
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include "concurrency/thread_pool.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+TEST(LatencyHistogramTest, Buckets) {
+  using H = hstl::LatencyHistogram;
+  // every value falls into the bucket whose range holds it
+  for (uint64_t v : {0ull, 1ull, 7ull, 8ull, 9ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull,
+                     ~0ull >> 1, ~0ull}) {
+    size_t b = H::bucket_of(v);
+    ASSERT_LT(b, H::kBuckets);
+    EXPECT_LE(H::lowest(b), v);
+    EXPECT_GE(H::highest(b), v);
+  }
+  // the buckets are contiguous and no wider than 1/8 of their values
+  for (size_t b = 0; b + 1 < H::kBuckets; b++) {
+    EXPECT_EQ(H::highest(b) + 1, H::lowest(b + 1));
+    EXPECT_LE(H::highest(b) - H::lowest(b), H::lowest(b) / H::kSubBuckets);
+  }
+  EXPECT_EQ(H::highest(H::kBuckets - 1), ~0ull);
+}
+
+TEST(LatencyHistogramTest, Percentiles) {
+  hstl::LatencyHistogram h;
+  EXPECT_EQ(h.snapshot().percentile(50), 0u);
+  for (uint64_t v = 1; v <= 1000; v++) {
+    h.record(v * 1000);
+  }
+  auto s = h.snapshot();
+  EXPECT_EQ(s.count(), 1000u);
+  EXPECT_NEAR(static_cast<double>(s.percentile(50)), 500000.0, 500000.0 / 8);
+  EXPECT_NEAR(static_cast<double>(s.percentile(99)), 990000.0, 990000.0 / 8);
+  EXPECT_GE(s.max(), 1000000u);
+
+  s.merge(s);
+  EXPECT_EQ(s.count(), 2000u);
+  EXPECT_NEAR(static_cast<double>(s.percentile(50)), 500000.0, 500000.0 / 8);
+}
+
+TEST(ThreadPoolStatsTest, Disabled) {
+  hstl::ThreadPool pool(2);
+  pool.submit([]() {}).get();
+  auto s = pool.stats();
+  EXPECT_EQ(s.workers.size(), 2u);
+  EXPECT_EQ(s.total().tasks_run, 0u);
+  EXPECT_EQ(s.threads, 2u);
+}
+
+TEST(ThreadPoolStatsTest, Counters) {
+  hstl::ThreadPoolOptions options;
+  options.collect_stats = true;
+  hstl::ThreadPool pool(2, options);
+
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(pool.submit([]() { std::this_thread::sleep_for(std::chrono::microseconds(100)); }));
+  }
+  for (auto &f : futures) {
+    f.get();
+  }
+  pool.wait_idle();
+
+  auto s = pool.stats();
+  auto total = s.total();
+  EXPECT_EQ(total.tasks_run, 100u);
+  EXPECT_EQ(total.queue_wait.count(), 100u);
+  EXPECT_EQ(total.run_time.count(), 100u);
+  EXPECT_GE(total.run_time.percentile(50), 100000u);
+  EXPECT_LE(total.steals, total.steal_attempts);
+  EXPECT_EQ(total.queue_depth, 0u);
+  EXPECT_EQ(s.pending, 0u);
+  EXPECT_EQ(s.outstanding, 0u);
+}
+
+TEST(ThreadPoolStatsTest, QueueDepthAndHelpers) {
+  hstl::ThreadPoolOptions options;
+  options.collect_stats = true;
+  options.idle = hstl::IdlePolicy::park();
+  hstl::ThreadPool pool(1, options);
+
+  std::promise<void> started;
+  std::promise<void> gate;
+  auto blocker = pool.submit([&started, f = gate.get_future().share()]() {
+    started.set_value();
+    f.wait();
+  });
+  started.get_future().wait();
+  for (int i = 0; i < 10; ++i) {
+    pool.post(hstl::TaskNode::create([]() {}));
+  }
+  auto s = pool.stats();
+  EXPECT_EQ(s.total().queue_depth, 10u);
+  EXPECT_EQ(s.pending, 10u);
+
+  // the calling thread takes the queued tasks, the worker is still blocked
+  while (pool.run_pending_task()) {
+  }
+  s = pool.stats();
+  EXPECT_EQ(s.helpers.tasks_run, 10u);
+  EXPECT_EQ(s.helpers.steals, 10u);
+  EXPECT_EQ(s.total().queue_depth, 0u);
+
+  gate.set_value();
+  blocker.get();
+  pool.wait_idle();
+  EXPECT_EQ(pool.stats().total().tasks_run, 11u);
+}
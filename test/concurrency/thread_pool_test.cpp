@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include "concurrency/thread_pool.h"
 
+#include <algorithm>
+#include <iostream>
+
 TEST(THREAD_POOL_TEST, TEST0) {
   hstl::ThreadPool pool(10);
 
@@ -94,4 +97,820 @@ TEST(ThreadPoolTest, TEST5) {
   
   auto fut2 = pool.submit([]() { return 100; });
   EXPECT_EQ(fut2.get(), 100);
-}
\ No newline at end of file
+}
+
+TEST(ThreadPoolTest, StealFromBusyWorker) {
+  hstl::ThreadPool pool(2);
+
+  // one worker queues the tasks into its own deque and blocks, the other must steal them
+  std::promise<void> started;
+  std::promise<void> release;
+  auto blocker_released = release.get_future();
+  std::atomic<int> counter(0);
+  std::vector<std::future<void>> futures;
+  auto blocker = pool.submit([&]() {
+    for (int i = 0; i < 100; ++i) {
+      futures.push_back(pool.submit([&counter]() {
+        counter.fetch_add(1, std::memory_order_relaxed);
+      }));
+    }
+    started.set_value();
+    blocker_released.wait();
+  });
+  started.get_future().wait();
+
+  // all of them finish while the blocker is still held
+  for (auto& fut : futures) {
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+  }
+  EXPECT_EQ(counter.load(), 100);
+  EXPECT_EQ(blocker.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+
+  release.set_value();
+  blocker.get();
+}
+
+TEST(ThreadPoolTest, SubmitFromWorker) {
+  hstl::ThreadPool pool(2);
+
+  std::atomic<int> counter(0);
+  auto outer = pool.submit([&pool, &counter]() {
+    std::vector<std::future<void>> inner;
+    for (int i = 0; i < 100; ++i) {
+      inner.push_back(pool.submit([&counter]() {
+        counter.fetch_add(1, std::memory_order_relaxed);
+      }));
+    }
+    return inner;
+  });
+
+  for (auto& fut : outer.get()) {
+    fut.get();
+  }
+  EXPECT_EQ(counter.load(), 100);
+}
+
+TEST(ThreadPoolTest, MultiProducer) {
+  hstl::ThreadPool pool(3);
+  // a second pool with a different size must not share the submission cursor
+  hstl::ThreadPool other(1);
+
+  const int producer_num = 4;
+  const int task_num = 1000;
+  std::atomic<int> counter(0);
+  std::vector<std::thread> producers;
+  for (int p = 0; p < producer_num; ++p) {
+    producers.emplace_back([&, p]() {
+      auto &target = p % 2 == 0 ? pool : other;
+      std::vector<std::future<void>> futures;
+      for (int i = 0; i < task_num; ++i) {
+        futures.push_back(target.submit([&counter]() {
+          counter.fetch_add(1, std::memory_order_relaxed);
+        }));
+      }
+      for (auto& fut : futures) {
+        fut.get();
+      }
+    });
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  EXPECT_EQ(counter.load(), producer_num * task_num);
+}
+
+TEST(ThreadPoolTest, SubmitN) {
+  hstl::ThreadPool pool(4);
+
+  const int task_num = 10000;
+  std::vector<std::atomic<int>> hits(task_num);
+  pool.submit_n(task_num, [&hits](size_t i) { hits[i].fetch_add(1, std::memory_order_relaxed); }).get();
+  for (int i = 0; i < task_num; ++i) {
+    ASSERT_EQ(hits[i].load(), 1);
+  }
+
+  // fewer tasks than workers
+  std::atomic<int> counter(0);
+  pool.submit_n(2, [&counter](size_t) { counter++; }).get();
+  EXPECT_EQ(counter.load(), 2);
+  pool.submit_n(0, [&counter](size_t) { counter++; }).get();
+  EXPECT_EQ(counter.load(), 2);
+}
+
+TEST(ThreadPoolTest, SubmitBatch) {
+  hstl::ThreadPool pool(3);
+
+  std::atomic<int> sum(0);
+  std::vector<std::function<void()>> tasks;
+  for (int i = 0; i < 100; ++i) {
+    tasks.push_back([&sum, i]() { sum.fetch_add(i, std::memory_order_relaxed); });
+  }
+  auto batch = pool.submit_batch(tasks.begin(), tasks.end());
+  batch.get();
+  EXPECT_EQ(sum.load(), 99 * 100 / 2);
+
+  // the handle can be chained like any other future
+  auto done = pool.submit_n(10, [&sum](size_t) { sum++; }).then([&sum]() { return sum.load(); });
+  EXPECT_EQ(done.get(), 99 * 100 / 2 + 10);
+}
+
+TEST(ThreadPoolTest, BatchException) {
+  hstl::ThreadPool pool(2);
+
+  std::atomic<int> counter(0);
+  auto batch = pool.submit_n(100, [&counter](size_t i) {
+    counter++;
+    if (i == 50) {
+      throw std::runtime_error("Test exception");
+    }
+  });
+  EXPECT_THROW(batch.get(), std::runtime_error);
+  // the batch fails only after the other tasks have run
+  EXPECT_EQ(counter.load(), 100);
+}
+
+TEST(ThreadPoolTest, BatchFromWorker) {
+  hstl::ThreadPool pool(2);
+
+  std::atomic<int> counter(0);
+  auto inner = pool.submit([&pool, &counter]() {
+    return pool.submit_n(1000, [&counter](size_t) { counter++; });
+  });
+  inner.get().get();
+  EXPECT_EQ(counter.load(), 1000);
+}
+
+TEST(ThreadPoolTest, IdlePolicies) {
+  for (auto policy : {hstl::IdlePolicy::park(), hstl::IdlePolicy::spin_then_park(),
+                      hstl::IdlePolicy::busy_spin()}) {
+    hstl::ThreadPoolOptions options;
+    options.idle = policy;
+    hstl::ThreadPool pool(3, options);
+
+    std::atomic<int> counter(0);
+    for (int round = 0; round < 3; ++round) {
+      pool.submit_n(100, [&counter](size_t) { counter++; }).get();
+      // let the workers run out of work and park
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      pool.submit([&counter]() { counter++; }).get();
+    }
+    EXPECT_EQ(counter.load(), 3 * 101);
+  }
+}
+
+TEST(ThreadPoolTest, Priorities) {
+  hstl::ThreadPoolOptions options;
+  options.aging_interval = 1000;
+  hstl::ThreadPool pool(1, options);
+
+  // keep the only worker busy until everything is queued
+  std::promise<void> started, gate;
+  auto blocker = pool.submit([&started, f = gate.get_future().share()]() {
+    started.set_value();
+    f.wait();
+  });
+  started.get_future().wait();
+
+  std::mutex lock;
+  std::vector<int> order;
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 10; ++i) {
+    futures.push_back(pool.submit(hstl::Priority::low, [&, i]() {
+      std::lock_guard guard(lock);
+      order.push_back(200 + i);
+    }));
+    futures.push_back(pool.submit(hstl::Priority::high, [&, i]() {
+      std::lock_guard guard(lock);
+      order.push_back(i);
+    }));
+    futures.push_back(pool.submit([&, i]() {
+      std::lock_guard guard(lock);
+      order.push_back(100 + i);
+    }));
+  }
+  gate.set_value();
+  for (auto &f : futures) {
+    f.get();
+  }
+  // served class by class, FIFO inside a class
+  ASSERT_EQ(order.size(), 30u);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(order[i], i);
+    EXPECT_EQ(order[10 + i], 100 + i);
+    EXPECT_EQ(order[20 + i], 200 + i);
+  }
+}
+
+TEST(ThreadPoolTest, PriorityAging) {
+  hstl::ThreadPoolOptions options;
+  options.aging_interval = 4;
+  hstl::ThreadPool pool(1, options);
+
+  std::promise<void> started, gate;
+  auto blocker = pool.submit([&started, f = gate.get_future().share()]() {
+    started.set_value();
+    f.wait();
+  });
+  started.get_future().wait();
+
+  std::atomic<int> high_done(0);
+  int high_before_low = -1;
+  auto low = pool.submit(hstl::Priority::low, [&]() { high_before_low = high_done.load(); });
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(pool.submit(hstl::Priority::high, [&]() { high_done++; }));
+  }
+  gate.set_value();
+  low.get();
+  for (auto &f : futures) {
+    f.get();
+  }
+  // the low priority task does not wait for all the high priority ones
+  EXPECT_EQ(high_before_low, 4);
+}
+
+TEST(ThreadPoolTest, PriorityStealing) {
+  hstl::ThreadPool pool(4);
+
+  std::atomic<int> counter(0);
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 300; ++i) {
+    auto priority = static_cast<hstl::Priority>(i % hstl::kPriorityLevels);
+    futures.push_back(pool.submit(priority, [&counter]() { counter++; }));
+  }
+  auto batch = pool.submit_n(300, [&counter](size_t) { counter++; }, hstl::Priority::low);
+  auto async = pool.async(hstl::Priority::high, []() { return 42; });
+  for (auto &f : futures) {
+    f.get();
+  }
+  batch.get();
+  EXPECT_EQ(async.get(), 42);
+  EXPECT_EQ(counter.load(), 600);
+}
+
+TEST(ThreadPoolTest, Affinity) {
+  int cpu = hstl::CpuTopology::allowed_cpus().back();
+  hstl::ThreadPoolOptions options;
+  options.cpus = {cpu};
+  hstl::ThreadPool pool(2, options);
+
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(pool.submit([]() {
+#if defined(__linux__)
+      return sched_getcpu();
+#else
+      return -1;
+#endif
+    }));
+  }
+  for (auto &f : futures) {
+#if defined(__linux__)
+    EXPECT_EQ(f.get(), cpu);
+#else
+    f.get();
+#endif
+  }
+
+  // pinned along the detected topology
+  hstl::ThreadPoolOptions topology_options;
+  topology_options.pin_workers = true;
+  hstl::ThreadPool topology_pool(4, topology_options);
+  std::atomic<int> counter(0);
+  topology_pool.submit_n(1000, [&counter](size_t) { counter++; }).get();
+  EXPECT_EQ(counter.load(), 1000);
+}
+
+TEST(ThreadPoolTest, WaitIdle) {
+  hstl::ThreadPool pool(4);
+
+  std::atomic<int> counter(0);
+  for (int phase = 1; phase <= 3; ++phase) {
+    for (int i = 0; i < 1000; ++i) {
+      pool.submit([&pool, &counter]() {
+        counter++;
+        // tasks submitted by tasks are waited for too
+        pool.async([&counter]() { counter++; });
+      });
+    }
+    pool.wait_idle();
+    EXPECT_EQ(counter.load(), phase * 2000);
+    EXPECT_EQ(pool.outstanding(), 0u);
+  }
+  // no-op when idle
+  pool.wait_idle();
+
+  auto from_worker = pool.submit([&pool]() { pool.wait_idle(); });
+  EXPECT_THROW(from_worker.get(), std::logic_error);
+}
+
+TEST(ThreadPoolTest, ShutdownDrain) {
+  hstl::ThreadPool pool(2);
+
+  std::atomic<int> counter(0);
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 1000; ++i) {
+    futures.push_back(pool.submit([&counter]() {
+      std::this_thread::sleep_for(std::chrono::microseconds(10));
+      counter++;
+    }));
+  }
+  pool.shutdown();
+  EXPECT_EQ(counter.load(), 1000);
+  for (auto &f : futures) {
+    f.get();
+  }
+  EXPECT_TRUE(pool.is_closed());
+  EXPECT_THROW(pool.submit([]() {}), std::runtime_error);
+  // a second shutdown is harmless
+  pool.shutdown_now();
+}
+
+TEST(ThreadPoolTest, ShutdownNow) {
+  hstl::ThreadPool pool(1);
+
+  std::promise<void> started, gate;
+  auto blocker = pool.submit([&started, f = gate.get_future().share()]() {
+    started.set_value();
+    f.wait();
+  });
+  started.get_future().wait();
+
+  std::vector<std::future<int>> queued;
+  for (int i = 0; i < 100; ++i) {
+    queued.push_back(pool.submit([i]() { return i; }));
+  }
+  auto continuation = pool.async([]() { return 1; }).then([](int x) { return x + 1; });
+
+  std::thread releaser([&gate]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    gate.set_value();
+  });
+  pool.shutdown_now();
+  releaser.join();
+
+  // the running task finishes, the queued ones are dropped with broken_promise
+  blocker.get();
+  for (auto &f : queued) {
+    EXPECT_THROW(f.get(), std::future_error);
+  }
+  EXPECT_THROW(continuation.get(), std::future_error);
+  EXPECT_EQ(pool.outstanding(), 0u);
+}
+
+TEST(ThreadPoolTest, CloseKeepsQueuedTasks) {
+  hstl::ThreadPool pool(2);
+
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(pool.submit([i]() { return i; }));
+  }
+  pool.close();
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(futures[i].get(), i);
+  }
+}
+
+TEST(ThreadPoolTest, ElasticGrowsWhenBlocked) {
+  hstl::ThreadPoolOptions options;
+  options.elastic.max_threads = 4;
+  options.elastic.stall_timeout = std::chrono::milliseconds(1);
+  hstl::ThreadPool pool(1, options);
+  EXPECT_EQ(pool.size(), 1u);
+
+  // every task blocks until all four run at the same time, which needs four workers
+  std::atomic<int> arrived{0};
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 4; ++i) {
+    futures.push_back(pool.submit([&arrived]() {
+      arrived.fetch_add(1);
+      while (arrived.load() < 4) {
+        std::this_thread::yield();
+      }
+    }));
+  }
+  for (auto &f : futures) {
+    f.get();
+  }
+  EXPECT_EQ(pool.size(), 4u);
+}
+
+TEST(ThreadPoolTest, ElasticGrowsWithQueueDepth) {
+  hstl::ThreadPoolOptions options;
+  options.elastic.max_threads = 3;
+  options.elastic.queue_depth = 4;
+  options.elastic.stall_timeout = std::chrono::hours(1);
+  hstl::ThreadPool pool(1, options);
+
+  std::promise<void> started;
+  std::promise<void> gate;
+  auto blocker = pool.submit([&started, f = gate.get_future().share()]() {
+    started.set_value();
+    f.wait();
+  });
+  started.get_future().wait();
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(pool.submit([i]() { return i; }));
+  }
+  EXPECT_GT(pool.size(), 1u);
+  gate.set_value();
+  blocker.get();
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(futures[i].get(), i);
+  }
+}
+
+TEST(ThreadPoolTest, ElasticRetiresIdleWorkers) {
+  hstl::ThreadPoolOptions options;
+  options.elastic.max_threads = 4;
+  options.elastic.min_threads = 2;
+  options.elastic.idle_timeout = std::chrono::milliseconds(5);
+  options.idle = hstl::IdlePolicy::park();
+  hstl::ThreadPool pool(4, options);
+  EXPECT_EQ(pool.size(), 4u);
+
+  for (int i = 0; i < 1000 && pool.size() > 2; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQ(pool.size(), 2u);
+
+  // the remaining workers (and those started again) still run everything
+  std::atomic<int> sum{0};
+  for (int round = 0; round < 3; ++round) {
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 1000; ++i) {
+      futures.push_back(pool.submit([&sum, i]() { sum.fetch_add(i); }));
+    }
+    for (auto &f : futures) {
+      f.get();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(sum.load(), 3 * 999 * 1000 / 2);
+  EXPECT_GE(pool.size(), 2u);
+}
+
+TEST(ThreadPoolTest, SubmitAfter) {
+  hstl::ThreadPool pool(2);
+  auto start = std::chrono::steady_clock::now();
+  std::promise<std::chrono::steady_clock::time_point> fired;
+  pool.submit_after(std::chrono::milliseconds(20), [&fired]() {
+    fired.set_value(std::chrono::steady_clock::now());
+  });
+  EXPECT_EQ(pool.timers(), 1u);
+  auto at = fired.get_future().get();
+  EXPECT_GE(at - start, std::chrono::milliseconds(20));
+  EXPECT_EQ(pool.timers(), 0u);
+
+  // a time in the past fires right away
+  std::promise<void> now;
+  pool.submit_at(start, [&now]() { now.set_value(); });
+  now.get_future().wait();
+}
+
+TEST(ThreadPoolTest, SubmitEvery) {
+  hstl::ThreadPool pool(2);
+  std::atomic<int> runs{0};
+  std::promise<void> done;
+  hstl::TimerHandle handle;
+  handle = pool.submit_every(std::chrono::milliseconds(2), [&runs, &done]() {
+    if (runs.fetch_add(1) + 1 == 5) {
+      done.set_value();
+    }
+  });
+  done.get_future().wait();
+  EXPECT_TRUE(handle.cancel());
+  EXPECT_FALSE(handle.cancel());
+  int seen = runs.load();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  // at most the run which was in flight during cancel()
+  EXPECT_LE(runs.load(), seen + 1);
+  EXPECT_EQ(pool.timers(), 0u);
+}
+
+TEST(ThreadPoolTest, TimersWithBusySpin) {
+  // the workers never park, so none of them becomes the timekeeper
+  hstl::ThreadPoolOptions options;
+  options.idle = hstl::IdlePolicy::busy_spin();
+  hstl::ThreadPool pool(2, options);
+  std::promise<void> fired;
+  pool.submit_after(std::chrono::milliseconds(5), [&fired]() { fired.set_value(); });
+  EXPECT_EQ(fired.get_future().wait_for(std::chrono::seconds(10)), std::future_status::ready);
+
+  std::atomic<int> runs{0};
+  std::promise<void> done;
+  auto handle = pool.submit_every(std::chrono::milliseconds(2), [&runs, &done]() {
+    if (runs.fetch_add(1) + 1 == 3) {
+      done.set_value();
+    }
+  });
+  EXPECT_EQ(done.get_future().wait_for(std::chrono::seconds(10)), std::future_status::ready);
+  handle.cancel();
+  pool.wait_idle();
+}
+
+TEST(ThreadPoolTest, CancelTimer) {
+  hstl::ThreadPool pool(2);
+  std::atomic<int> fired{0};
+  std::vector<hstl::TimerHandle> handles;
+  for (int i = 0; i < 100000; ++i) {
+    handles.push_back(pool.submit_after(std::chrono::milliseconds(1 + i % 50), [&fired]() { fired++; }));
+  }
+  // cancel every other timer, most of them have not fired yet
+  int cancelled = 0;
+  for (size_t i = 0; i < handles.size(); i += 2) {
+    cancelled += handles[i].cancel();
+  }
+  EXPECT_GT(cancelled, 0);
+  for (int i = 0; i < 1000 && pool.timers() > 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  pool.wait_idle();
+  EXPECT_EQ(fired.load(), 100000 - cancelled);
+  EXPECT_FALSE(handles[1].cancel());
+  EXPECT_FALSE(hstl::TimerHandle().cancel());
+}
+
+TEST(ThreadPoolTest, TimersDroppedAtShutdown) {
+  auto pool = std::make_unique<hstl::ThreadPool>(1);
+  auto counter = std::make_shared<int>(0);
+  auto handle = pool->submit_after(std::chrono::hours(1), [counter]() { (*counter)++; });
+  pool->submit_every(std::chrono::hours(1), [counter]() { (*counter)++; });
+  EXPECT_EQ(counter.use_count(), 3);
+  pool.reset();
+  // both callables were destroyed without running
+  EXPECT_EQ(counter.use_count(), 1);
+  EXPECT_EQ(*counter, 0);
+}
+
+TEST(ThreadPoolTest, ErrorHandler) {
+  std::atomic<int> handled{0};
+  hstl::ThreadPoolOptions options;
+  options.on_error = [&handled](std::exception_ptr error) {
+    try {
+      std::rethrow_exception(error);
+    } catch (const std::runtime_error &) {
+      handled++;
+    }
+  };
+  hstl::ThreadPool pool(2, options);
+  for (int i = 0; i < 100; ++i) {
+    pool.post(hstl::TaskNode::create([]() { throw std::runtime_error("Test exception"); }));
+  }
+  // a submitted task keeps its exception in the future, the handler does not see it
+  auto res = pool.submit([]() { throw std::runtime_error("Test exception"); });
+  pool.wait_idle();
+  EXPECT_EQ(handled.load(), 100);
+  EXPECT_THROW(res.get(), std::runtime_error);
+  EXPECT_TRUE(pool.drain_errors().empty());
+}
+
+TEST(ThreadPoolTest, ErrorRing) {
+  hstl::ThreadPoolOptions options;
+  options.error_ring_capacity = 64;
+  options.collect_stats = true;
+  hstl::ThreadPool pool(2, options);
+  for (int i = 0; i < 100; ++i) {
+    pool.post(hstl::TaskNode::create([i]() {
+      if (i % 2 == 0) {
+        throw std::runtime_error("Test exception");
+      }
+    }));
+  }
+  pool.wait_idle();
+  auto errors = pool.drain_errors();
+  EXPECT_EQ(errors.size(), 50u);
+  EXPECT_EQ(pool.dropped_errors(), 0u);
+  EXPECT_THROW(std::rethrow_exception(errors[0]), std::runtime_error);
+  EXPECT_TRUE(pool.drain_errors().empty());
+  EXPECT_EQ(pool.stats().total().tasks_failed, 50u);
+
+  // the ring keeps the first errors and counts the rest
+  for (int i = 0; i < 100; ++i) {
+    pool.post(hstl::TaskNode::create([]() { throw std::runtime_error("Test exception"); }));
+  }
+  pool.wait_idle();
+  EXPECT_EQ(pool.drain_errors().size(), 64u);
+  EXPECT_EQ(pool.dropped_errors(), 36u);
+}
+
+namespace {
+
+// every level waits for its right half on the pool
+void pool_quicksort(hstl::ThreadPool &pool, int *first, int *last) {
+  if (last - first < 64) {
+    std::sort(first, last);
+    return;
+  }
+  int pivot = first[(last - first) / 2];
+  int *mid1 = std::partition(first, last, [pivot](int v) { return v < pivot; });
+  int *mid2 = std::partition(mid1, last, [pivot](int v) { return v == pivot; });
+  auto right = pool.submit([&pool, mid2, last]() { pool_quicksort(pool, mid2, last); });
+  pool_quicksort(pool, first, mid1);
+  pool.get(right);
+}
+
+}
+
+TEST(ThreadPoolTest, HelpingWaitNested) {
+  // with a blocking get() the only worker would wait for a task queued behind itself
+  hstl::ThreadPool pool(1);
+  std::vector<int> values(100000);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = static_cast<int>((i * 7919) % 10007);
+  }
+  auto res = pool.submit([&pool, &values]() { pool_quicksort(pool, values.data(), values.data() + values.size()); });
+  ASSERT_EQ(res.wait_for(std::chrono::seconds(30)), std::future_status::ready);
+  res.get();
+  EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+}
+
+TEST(ThreadPoolTest, HelpingWaitFutures) {
+  hstl::ThreadPool pool(1);
+  auto res = pool.submit([&pool]() {
+    auto a = pool.async([]() { return 1; });
+    auto b = pool.submit([]() { return 2; }).share();
+    auto c = pool.submit([]() { throw std::runtime_error("Test exception"); });
+    int sum = pool.get(a) + pool.get(b);
+    EXPECT_THROW(pool.get(c), std::runtime_error);
+    return sum;
+  });
+  // not a worker, blocks
+  pool.wait(res);
+  EXPECT_EQ(res.get(), 3);
+}
+
+namespace {
+
+// a pool of one worker, blocked until the returned promise is set
+std::unique_ptr<hstl::ThreadPool> blocked_pool(const hstl::ThreadPoolOptions &options, std::promise<void> &gate) {
+  auto pool = std::make_unique<hstl::ThreadPool>(1, options);
+  std::promise<void> started;
+  pool->post(hstl::TaskNode::create([&started, f = gate.get_future().share()]() {
+    started.set_value();
+    f.wait();
+  }));
+  started.get_future().wait();
+  return pool;
+}
+
+}
+
+TEST(ThreadPoolTest, BoundedBlock) {
+  hstl::ThreadPoolOptions options;
+  options.capacity = 4;
+  std::promise<void> gate;
+  auto pool = blocked_pool(options, gate);
+  std::vector<std::future<int>> res;
+  for (int i = 0; i < 4; ++i) {
+    res.push_back(pool->submit([i]() { return i; }));
+  }
+  EXPECT_EQ(pool->queued(), 4u);
+
+  std::atomic<bool> submitted{false};
+  std::thread producer([&]() {
+    res.push_back(pool->submit([]() { return 4; }));
+    submitted = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(submitted.load());
+  gate.set_value();
+  producer.join();
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(res[i].get(), i);
+  }
+  EXPECT_EQ(pool->queued(), 0u);
+}
+
+TEST(ThreadPoolTest, BoundedTrySubmitAndFail) {
+  hstl::ThreadPoolOptions options;
+  options.capacity = 2;
+  options.overflow = hstl::OverflowPolicy::fail;
+  std::promise<void> gate;
+  auto pool = blocked_pool(options, gate);
+  auto [s1, f1] = pool->try_submit([]() { return 1; });
+  auto [s2, f2] = pool->try_submit(hstl::Priority::high, []() { return 2; });
+  auto [s3, f3] = pool->try_submit([]() { return 3; });
+  EXPECT_EQ(s1, hstl::SubmitStatus::ok);
+  EXPECT_EQ(s2, hstl::SubmitStatus::ok);
+  EXPECT_EQ(s3, hstl::SubmitStatus::full);
+  EXPECT_FALSE(f3.valid());
+  EXPECT_THROW(pool->submit([]() {}), std::runtime_error);
+
+  gate.set_value();
+  EXPECT_EQ(f1.get() + f2.get(), 3);
+  pool->close();
+  EXPECT_EQ(pool->try_submit([]() {}).first, hstl::SubmitStatus::closed);
+}
+
+TEST(ThreadPoolTest, BoundedCallerRuns) {
+  hstl::ThreadPoolOptions options;
+  options.capacity = 1;
+  options.overflow = hstl::OverflowPolicy::caller_runs;
+  std::promise<void> gate;
+  auto pool = blocked_pool(options, gate);
+  auto queued = pool->submit([]() { return std::this_thread::get_id(); });
+  auto inline_run = pool->submit([]() { return std::this_thread::get_id(); });
+  ASSERT_EQ(inline_run.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+  EXPECT_EQ(inline_run.get(), std::this_thread::get_id());
+  gate.set_value();
+  EXPECT_NE(queued.get(), std::this_thread::get_id());
+}
+
+TEST(ThreadPoolTest, BoundedDropOldest) {
+  hstl::ThreadPoolOptions options;
+  options.capacity = 3;
+  options.overflow = hstl::OverflowPolicy::drop_oldest;
+  std::promise<void> gate;
+  auto pool = blocked_pool(options, gate);
+  std::vector<std::future<int>> res;
+  for (int i = 0; i < 5; ++i) {
+    res.push_back(pool->submit([i]() { return i; }));
+  }
+  EXPECT_EQ(pool->queued(), 3u);
+  gate.set_value();
+  // the two oldest were discarded
+  EXPECT_THROW(res[0].get(), std::future_error);
+  EXPECT_THROW(res[1].get(), std::future_error);
+  for (int i = 2; i < 5; ++i) {
+    EXPECT_EQ(res[i].get(), i);
+  }
+}
+
+TEST(ThreadPoolTest, BoundedSubmitN) {
+  hstl::ThreadPoolOptions options;
+  options.capacity = 4;
+  std::promise<void> gate;
+  auto pool = blocked_pool(options, gate);
+  std::atomic<int> counter{0};
+  std::atomic<bool> submitted{false};
+  hstl::future<void> batch;
+  std::thread producer([&]() {
+    batch = pool->submit_n(10, [&counter](size_t) { counter++; });
+    submitted = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  // the batch waits for slots like single submissions
+  EXPECT_FALSE(submitted.load());
+  EXPECT_EQ(pool->queued(), 4u);
+  gate.set_value();
+  producer.join();
+  batch.get();
+  EXPECT_EQ(counter.load(), 10);
+  EXPECT_EQ(pool->queued(), 0u);
+}
+
+TEST(ThreadPoolTest, BoundedSubmitNFailAndCallerRuns) {
+  hstl::ThreadPoolOptions options;
+  options.capacity = 2;
+  options.overflow = hstl::OverflowPolicy::fail;
+  std::promise<void> gate;
+  auto pool = blocked_pool(options, gate);
+  std::atomic<int> counter{0};
+  // a batch which does not fit is rejected as a whole
+  EXPECT_THROW(pool->submit_n(3, [&counter](size_t) { counter++; }), std::runtime_error);
+  auto batch = pool->submit_n(2, [&counter](size_t) { counter++; });
+  EXPECT_EQ(pool->queued(), 2u);
+  EXPECT_THROW(pool->submit_n(1, [&counter](size_t) { counter++; }), std::runtime_error);
+  gate.set_value();
+  batch.get();
+  EXPECT_EQ(counter.load(), 2);
+
+  options.capacity = 1;
+  options.overflow = hstl::OverflowPolicy::caller_runs;
+  std::promise<void> gate2;
+  pool = blocked_pool(options, gate2);
+  std::atomic<int> on_caller{0};
+  auto caller = std::this_thread::get_id();
+  auto runs = pool->submit_n(3, [&on_caller, caller](size_t) {
+    on_caller += std::this_thread::get_id() == caller;
+  });
+  // one task got the slot, the others ran here
+  EXPECT_EQ(on_caller.load(), 2);
+  gate2.set_value();
+  runs.get();
+  EXPECT_EQ(on_caller.load(), 2);
+}
+
+TEST(ThreadPoolTest, BoundedWorkersNotHeldBack) {
+  hstl::ThreadPoolOptions options;
+  options.capacity = 2;
+  options.overflow = hstl::OverflowPolicy::fail;
+  hstl::ThreadPool pool(1, options);
+  // a task fans out beyond the capacity, it must neither block nor throw
+  auto res = pool.submit([&pool]() {
+    std::vector<std::future<int>> children;
+    for (int i = 0; i < 100; ++i) {
+      children.push_back(pool.submit([i]() { return i; }));
+    }
+    int sum = 0;
+    for (auto &c : children) {
+      sum += pool.get(c);
+    }
+    return sum;
+  });
+  EXPECT_EQ(res.get(), 4950);
+  pool.wait_idle();
+  EXPECT_EQ(pool.queued(), 0u);
+}
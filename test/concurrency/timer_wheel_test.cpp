@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "concurrency/timer_wheel.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Timer : hstl::TimerWheelNode {
+  uint64_t fired_at = 0;
+};
+
+}  // namespace
+
+TEST(TimerWheelTest, FiresAtDeadline) {
+  hstl::TimerWheel wheel(1000);
+  std::vector<Timer> timers(6);
+  uint64_t deadlines[] = {1001, 1255, 1256, 1000 + 70000, 1000 + (uint64_t(1) << 25), 900};
+  for (size_t i = 0; i < timers.size(); i++) {
+    timers[i].deadline = deadlines[i];
+    wheel.insert(&timers[i]);
+  }
+  EXPECT_EQ(wheel.size(), 6u);
+  EXPECT_EQ(wheel.next_event(), 1001u);
+
+  // a deadline in the past fires at the next tick
+  uint64_t now = 1000;
+  while (wheel.size() > 0) {
+    now = std::min(wheel.next_event(), now + 1000);
+    wheel.advance(now, [now](hstl::TimerWheelNode* node) {
+      static_cast<Timer*>(node)->fired_at = now;
+    });
+  }
+  deadlines[5] = 1001;
+  for (size_t i = 0; i < timers.size(); i++) {
+    EXPECT_EQ(timers[i].fired_at, deadlines[i]) << i;
+    EXPECT_FALSE(timers[i].linked());
+  }
+}
+
+TEST(TimerWheelTest, Erase) {
+  hstl::TimerWheel wheel;
+  Timer a;
+  Timer b;
+  a.deadline = 10;
+  b.deadline = 100000;
+  wheel.insert(&a);
+  wheel.insert(&b);
+  wheel.erase(&a);
+  wheel.erase(&b);
+  EXPECT_EQ(wheel.size(), 0u);
+  EXPECT_EQ(wheel.next_event(), hstl::TimerWheel::kNever);
+  int fired = 0;
+  wheel.advance(200000, [&fired](hstl::TimerWheelNode*) { fired++; });
+  EXPECT_EQ(fired, 0);
+  EXPECT_EQ(wheel.now(), 200000u);
+}
+
+TEST(TimerWheelTest, RandomDeadlinesInOrder) {
+  hstl::TimerWheel wheel;
+  std::mt19937_64 rng(42);
+  std::vector<Timer> timers(10000);
+  for (auto& t : timers) {
+    t.deadline = 1 + rng() % 5000000;
+    wheel.insert(&t);
+  }
+  // advance in uneven steps, every timer fires exactly once, on its tick
+  uint64_t now = 0;
+  uint64_t last = 0;
+  size_t fired = 0;
+  while (wheel.size() > 0) {
+    now += 1 + rng() % 3000;
+    wheel.advance(now, [&](hstl::TimerWheelNode* node) {
+      // the clock steps tick by tick, a timer fires exactly on its tick
+      EXPECT_EQ(node->deadline, wheel.now());
+      EXPECT_GE(node->deadline, last);
+      last = node->deadline;
+      fired++;
+    });
+    EXPECT_EQ(wheel.now(), now);
+  }
+  EXPECT_EQ(fired, timers.size());
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "concurrency/work_stealing_deque.hpp"
+
+TEST(WorkStealingDequeTest, OwnerLifoThiefFifo) {
+  hstl::WorkStealingDeque<int> deque(2);
+  int values[4] = {0, 1, 2, 3};
+  for (auto &v : values) {
+    deque.push(&v);
+  }
+  ASSERT_EQ(deque.size(), 4);
+
+  ASSERT_EQ(deque.pop(), &values[3]);
+  ASSERT_EQ(deque.steal(), &values[0]);
+  ASSERT_EQ(deque.pop(), &values[2]);
+  ASSERT_EQ(deque.steal(), &values[1]);
+  ASSERT_EQ(deque.pop(), nullptr);
+  ASSERT_EQ(deque.steal(), nullptr);
+  ASSERT_TRUE(deque.empty());
+}
+
+TEST(WorkStealingDequeTest, Reserve) {
+  hstl::WorkStealingDeque<int> deque(2);
+  int values[3] = {0, 1, 2};
+  deque.push(&values[0]);
+  deque.push(&values[1]);
+  ASSERT_EQ(deque.steal(), &values[0]);
+  deque.reserve(1000);
+  deque.push(&values[2]);
+  ASSERT_EQ(deque.size(), 2);
+  ASSERT_EQ(deque.steal(), &values[1]);
+  ASSERT_EQ(deque.pop(), &values[2]);
+  ASSERT_TRUE(deque.empty());
+}
+
+TEST(WorkStealingDequeTest, ConcurrentSteal) {
+  const int n = 100000;
+  const int thief_num = 3;
+  hstl::WorkStealingDeque<int> deque;
+  std::vector<int> values(n);
+  std::vector<std::atomic<int>> taken(n);
+
+  std::atomic<bool> done(false);
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < thief_num; i++) {
+    thieves.emplace_back([&]() {
+      while (!done.load(std::memory_order_acquire) || !deque.empty()) {
+        if (int *p = deque.steal()) {
+          taken[p - values.data()].fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+
+  for (int i = 0; i < n; i++) {
+    deque.push(&values[i]);
+    if (i % 3 == 0) {
+      if (int *p = deque.pop()) {
+        taken[p - values.data()].fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+  while (int *p = deque.pop()) {
+    taken[p - values.data()].fetch_add(1, std::memory_order_relaxed);
+  }
+  done.store(true, std::memory_order_release);
+  for (auto &t : thieves) {
+    t.join();
+  }
+
+  // every element is taken exactly once
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(taken[i].load(), 1);
+  }
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+#include "memory.hpp"
+
+struct Point {
+  int x;
+  int y;
+};
+
+struct CountedCopy {
+  static int copy_ctor_count;
+
+  int value_;
+
+  explicit CountedCopy(int v) : value_(v) {}
+  CountedCopy(const CountedCopy& c) : value_(c.value_) { ++copy_ctor_count; }
+};
+
+int CountedCopy::copy_ctor_count = 0;
+
+TEST(MemoryTest, TraitsTest) {
+  using hstl::memory_detail::is_bitwise_constructible;
+  using hstl::memory_detail::is_bitwise_fillable;
+  // 指针区间且可平凡拷贝
+  ASSERT_TRUE((is_bitwise_constructible<int*, int*, int&>::value));
+  ASSERT_TRUE((is_bitwise_constructible<const Point*, Point*, const Point&>::value));
+  ASSERT_TRUE((is_bitwise_constructible<Point*, Point*, Point&&>::value));
+  // 类型不同、不可平凡拷贝、不是指针
+  ASSERT_FALSE((is_bitwise_constructible<int*, long*, int&>::value));
+  ASSERT_FALSE((is_bitwise_constructible<CountedCopy*, CountedCopy*, CountedCopy&>::value));
+  ASSERT_FALSE((is_bitwise_constructible<std::string*, std::string*, std::string&>::value));
+  ASSERT_FALSE((is_bitwise_constructible<std::move_iterator<int*>, int*, int&&>::value));
+
+  ASSERT_TRUE((is_bitwise_fillable<int*, const int&>::value));
+  ASSERT_TRUE((is_bitwise_fillable<long*, const int&>::value));
+  ASSERT_FALSE((is_bitwise_fillable<CountedCopy*, const CountedCopy&>::value));
+}
+
+TEST(MemoryTest, CopyAndMoveTest) {
+  int src[5] = {1, 2, 3, 4, 5};
+  int dst[5] = {};
+  ASSERT_EQ(hstl::uninitialized_copy(src, src + 5, dst), dst + 5);
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(dst[i], i + 1);
+  }
+
+  const Point points[2] = {{1, 2}, {3, 4}};
+  Point moved[2];
+  ASSERT_EQ(hstl::uninitialized_move(points, points + 2, moved), moved + 2);
+  ASSERT_EQ(moved[1].x, 3);
+  ASSERT_EQ(moved[1].y, 4);
+
+  // 空区间，指针可以是nullptr
+  int* none = nullptr;
+  ASSERT_EQ(hstl::uninitialized_copy(none, none, dst), dst);
+
+  // 不可平凡拷贝的类型仍然逐个调用构造函数
+  CountedCopy::copy_ctor_count = 0;
+  std::allocator<CountedCopy> alloc;
+  CountedCopy from[3] = {CountedCopy(1), CountedCopy(2), CountedCopy(3)};
+  CountedCopy* to = alloc.allocate(3);
+  hstl::uninitialized_copy(from, from + 3, to);
+  ASSERT_EQ(CountedCopy::copy_ctor_count, 3);
+  ASSERT_EQ(to[2].value_, 3);
+  alloc.deallocate(to, 3);
+
+  std::string strings[2] = {"hello", "world"};
+  std::allocator<std::string> string_alloc;
+  std::string* s = string_alloc.allocate(2);
+  hstl::uninitialized_move(strings, strings + 2, s);
+  ASSERT_EQ(s[1], "world");
+  hstl::destroy(s, s + 2);
+  string_alloc.deallocate(s, 2);
+}
+
+TEST(MemoryTest, FillTest) {
+  // 字节相同(memset)
+  int zeros[100];
+  hstl::uninitialized_fill_n(zeros, 100, 0);
+  int minus_one[100];
+  hstl::uninitialized_fill_n(minus_one, 100, -1);
+  char chars[100];
+  hstl::uninitialized_fill_n(chars, 100, 'x');
+  // 字节不同
+  int values[100];
+  ASSERT_EQ(hstl::uninitialized_fill_n(values, 100, 0x01020304), values + 100);
+  double doubles[100];
+  hstl::uninitialized_fill_n(doubles, 100, 1.5);
+  Point points[100];
+  hstl::uninitialized_fill_n(points, 100, Point{7, 7});
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(zeros[i], 0);
+    ASSERT_EQ(minus_one[i], -1);
+    ASSERT_EQ(chars[i], 'x');
+    ASSERT_EQ(values[i], 0x01020304);
+    ASSERT_EQ(doubles[i], 1.5);
+    ASSERT_EQ(points[i].y, 7);
+  }
+
+  int untouched[2] = {5, 5};
+  ASSERT_EQ(hstl::uninitialized_fill_n(untouched, 0, 1), untouched);
+  ASSERT_EQ(hstl::uninitialized_fill_n(untouched, -1, 1), untouched);
+  ASSERT_EQ(untouched[0], 5);
+}
+
+struct CountedDtor {
+  static int dtor_count;
+  ~CountedDtor() { ++dtor_count; }
+};
+
+int CountedDtor::dtor_count = 0;
+
+TEST(MemoryTest, DestroyTest) {
+  ASSERT_TRUE(hstl::is_trivially_destructible_v<int>);
+  ASSERT_TRUE(hstl::is_trivially_destructible_v<Point>);
+  ASSERT_TRUE(hstl::is_trivially_destructible_v<CountedCopy>);
+  ASSERT_FALSE(hstl::is_trivially_destructible_v<CountedDtor>);
+  ASSERT_FALSE(hstl::is_trivially_destructible_v<std::string>);
+
+  CountedDtor::dtor_count = 0;
+  std::allocator<CountedDtor> alloc;
+  CountedDtor* p = alloc.allocate(3);
+  hstl::uninitialized_fill_n(p, 3, CountedDtor());
+  ASSERT_EQ(CountedDtor::dtor_count, 1);
+  hstl::destroy(p, p + 3);
+  ASSERT_EQ(CountedDtor::dtor_count, 4);
+  alloc.deallocate(p, 3);
+
+  // 什么都不做
+  int ints[3] = {1, 2, 3};
+  hstl::destroy(ints, ints + 3);
+  hstl::destroy_at(ints);
+}
+
+TEST(MemoryTest, AllocateAtLeastTest) {
+  std::allocator<int> alloc;
+  auto result = hstl::allocate_at_least(alloc, 10);
+  ASSERT_EQ(result.count, 10);
+  alloc.deallocate(result.ptr, result.count);
+
+  hstl::malloc_allocator<int> malloc_alloc;
+  auto small = hstl::allocate_at_least(malloc_alloc, 3);
+  ASSERT_GE(small.count, 3);
+  small.ptr[small.count - 1] = 1;
+  malloc_alloc.deallocate(small.ptr, small.count);
+
+  // 大块内存(madvise huge page)
+  size_t n = 2 * hstl::malloc_allocator<int>::kHugePageSize / sizeof(int);
+  auto large = malloc_alloc.allocate_at_least(n);
+  ASSERT_GE(large.count, n);
+  large.ptr[0] = 1;
+  large.ptr[large.count - 1] = 1;
+  malloc_alloc.deallocate(large.ptr, large.count);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <type_traits>
+
+#include "small_vector.hpp"
+#include "span.hpp"
+
+// 统计分配的次数
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+  static int allocations;
+
+  CountingAllocator() = default;
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>&) {}
+
+  T* allocate(size_t n) {
+    ++allocations;
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T* p, size_t n) { std::allocator<T>().deallocate(p, n); }
+};
+
+template <typename T>
+int CountingAllocator<T>::allocations = 0;
+
+TEST(SmallVectorTest, InlineTest) {
+  CountingAllocator<int>::allocations = 0;
+  hstl::small_vector<int, 4, CountingAllocator<int>> vec;
+  ASSERT_TRUE(vec.is_inline());
+  ASSERT_EQ(vec.capacity(), 4);
+  for (int i = 0; i < 4; ++i) {
+    vec.push_back(i);
+  }
+  vec.insert(vec.begin(), 9);
+  // 第5个元素时才分配
+  ASSERT_EQ(CountingAllocator<int>::allocations, 1);
+  ASSERT_FALSE(vec.is_inline());
+  ASSERT_EQ(vec.size(), 5);
+  ASSERT_EQ(vec[0], 9);
+  ASSERT_EQ(vec[4], 3);
+
+  vec.erase(vec.begin(), vec.begin() + 2);
+  vec.shrink_to_fit();
+  ASSERT_TRUE(vec.is_inline());
+  ASSERT_EQ(vec.capacity(), 4);
+  ASSERT_EQ(vec[0], 1);
+  ASSERT_EQ(vec[2], 3);
+
+  hstl::small_vector<int, 4> filled(3, 7);
+  ASSERT_TRUE(filled.is_inline());
+  ASSERT_EQ(filled[2], 7);
+  filled.assign(10, filled[0]);
+  ASSERT_EQ(filled.size(), 10);
+  ASSERT_EQ(filled[9], 7);
+}
+
+TEST(SmallVectorTest, CopyMoveTest) {
+  hstl::small_vector<std::string, 2> small{"a", "b"};
+  hstl::small_vector<std::string, 2> large{"a", "b", "c"};
+  ASSERT_TRUE(small.is_inline());
+  ASSERT_FALSE(large.is_inline());
+
+  hstl::small_vector<std::string, 2> copy(small);
+  ASSERT_EQ(copy[1], "b");
+  copy = large;
+  ASSERT_EQ(copy.size(), 3);
+  ASSERT_EQ(copy[2], "c");
+
+  // 内联时移动元素，否则拿走内存
+  hstl::small_vector<std::string, 2> moved(std::move(small));
+  ASSERT_TRUE(moved.is_inline());
+  ASSERT_EQ(moved[0], "a");
+  ASSERT_TRUE(small.empty());
+  const std::string* data = large.data();
+  moved = std::move(large);
+  ASSERT_EQ(moved.data(), data);
+  ASSERT_TRUE(large.empty());
+  ASSERT_TRUE(large.is_inline());
+
+  large.push_back("x");
+  swap(large, moved);
+  ASSERT_EQ(large.size(), 3);
+  ASSERT_EQ(large[2], "c");
+  ASSERT_EQ(moved.size(), 1);
+  ASSERT_EQ(moved[0], "x");
+  ASSERT_TRUE(moved.is_inline());
+
+  // 不能当作vector使用：vector::swap会把内联缓冲区的地址交给另一个对象
+  using Base = hstl::vector<std::string,
+                            hstl::small_vector_detail::inline_allocator<std::string, 2, std::allocator<std::string>>>;
+  ASSERT_FALSE((std::is_convertible_v<hstl::small_vector<std::string, 2>&, Base&>));
+}
+
+TEST(SmallVectorTest, SpanTest) {
+  hstl::small_vector<int, 8> vec{1, 2, 3};
+  hstl::span<int> s = vec;
+  ASSERT_EQ(s.data(), vec.data());
+  ASSERT_EQ(s.size(), 3);
+  s[0] = 5;
+  ASSERT_EQ(vec[0], 5);
+
+  const auto& const_vec = vec;
+  hstl::span<const int> cs = const_vec;
+  int sum = 0;
+  for (int v : cs.subspan(1, 2)) {
+    sum += v;
+  }
+  ASSERT_EQ(sum, 5);
+
+  hstl::vector<int> heap{4, 5};
+  hstl::span<int> hs = heap;
+  ASSERT_EQ(hs.back(), 5);
+}
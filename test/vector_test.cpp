@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
+#include <string>
 #include <vector>
 
+#include "shared_ptr.hpp"
+#include "unique_ptr.hpp"
 #include "vector.hpp"
 
 TEST(VectorTest, BasicTest) {
@@ -165,4 +168,154 @@ TEST(VectorTest, ReserveTest) {
   vec.reserve(2);
   ASSERT_EQ(vec.capacity(), 10);
   ASSERT_EQ(vec.size(), 3);
-}
\ No newline at end of file
+}
+
+struct DtorFoo {
+  static int dtor_count;
+
+  int value_;
+
+  explicit DtorFoo(int v): value_(v) {}
+  ~DtorFoo() { ++dtor_count; }
+};
+
+int DtorFoo::dtor_count = 0;
+
+TEST(VectorTest, EraseClearTest) {
+  hstl::vector<int> vec{0, 1, 2, 3, 4, 5};
+  auto it = vec.erase(vec.begin() + 1, vec.begin() + 3);
+  ASSERT_EQ(*it, 3);
+  ASSERT_EQ(vec.size(), 4);
+  it = vec.erase(vec.begin());
+  ASSERT_EQ(*it, 3);
+  ASSERT_EQ(vec[2], 5);
+  vec.clear();
+  ASSERT_TRUE(vec.empty());
+  ASSERT_EQ(vec.capacity(), 6);
+
+  // 不可平凡析构的元素仍然逐个析构
+  DtorFoo::dtor_count = 0;
+  {
+    hstl::vector<DtorFoo> foos;
+    foos.reserve(4);
+    for (int i = 0; i < 4; ++i) {
+      foos.emplace_back(i);
+    }
+    foos.erase(foos.begin() + 1);
+    ASSERT_EQ(DtorFoo::dtor_count, 1);
+    ASSERT_EQ(foos[1].value_, 2);
+    foos.clear();
+    ASSERT_EQ(DtorFoo::dtor_count, 4);
+    foos.emplace_back(7);
+  }
+  ASSERT_EQ(DtorFoo::dtor_count, 5);
+}
+
+TEST(VectorTest, ResizeTest) {
+  hstl::vector<int> vec(2, 1);
+  vec.resize(5, 2);
+  ASSERT_EQ(vec.size(), 5);
+  ASSERT_GE(vec.capacity(), 5);
+  ASSERT_EQ(vec[1], 1);
+  ASSERT_EQ(vec[4], 2);
+  vec.resize(1);
+  ASSERT_EQ(vec.size(), 1);
+  ASSERT_EQ(vec[0], 1);
+}
+
+TEST(VectorTest, GrowthPolicyTest) {
+  hstl::vector<int, std::allocator<int>, hstl::one_and_half_growth> vec;
+  std::vector<size_t> capacities;
+  for (int i = 0; i < 20; ++i) {
+    vec.push_back(i);
+    if (capacities.empty() || capacities.back() != vec.capacity()) {
+      capacities.push_back(vec.capacity());
+    }
+  }
+  ASSERT_EQ(capacities, (std::vector<size_t>{1, 2, 3, 4, 6, 9, 13, 19, 28}));
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_EQ(vec[i], i);
+  }
+  // 一次插入多个元素时不小于所需的大小
+  vec.insert(vec.begin(), size_t(100), 1);
+  ASSERT_EQ(vec.size(), 120);
+  ASSERT_EQ(vec.capacity(), 120);
+
+  // 32MB以下与Base相同，之后取整到2MB
+  using huge = hstl::huge_page_growth<hstl::one_and_half_growth>;
+  ASSERT_EQ(huge::grow(1000, 4), 1500);
+  size_t next = huge::grow(size_t(8) << 20, 4);
+  ASSERT_EQ(next * 4 % (size_t(2) << 20), 0);
+  ASSERT_GE(next, size_t(12) << 20);
+}
+
+TEST(VectorTest, MallocAllocatorTest) {
+  // 分配器多给的部分也算作容量
+  hstl::vector<char, hstl::malloc_allocator<char>> vec;
+  vec.push_back('a');
+  ASSERT_GE(vec.capacity(), 1);
+  vec.reserve(100);
+  ASSERT_GE(vec.capacity(), 100);
+
+  hstl::vector<int, hstl::malloc_allocator<int>, hstl::huge_page_growth<>> ints;
+  for (int i = 0; i < 1000000; ++i) {
+    ints.push_back(i);
+  }
+  for (int i = 0; i < 1000000; ++i) {
+    ASSERT_EQ(ints[i], i);
+  }
+}
+
+TEST(VectorTest, RelocationTest) {
+  ASSERT_TRUE(hstl::is_trivially_relocatable_v<int>);
+  ASSERT_TRUE(hstl::is_trivially_relocatable_v<int*>);
+  ASSERT_TRUE(hstl::is_trivially_relocatable_v<hstl::unique_ptr<int>>);
+  ASSERT_TRUE(hstl::is_trivially_relocatable_v<hstl::shared_ptr<int>>);
+  ASSERT_FALSE(hstl::is_trivially_relocatable_v<CopyMoveFoo>);
+
+  // realloc
+  hstl::vector<hstl::unique_ptr<int>, hstl::malloc_allocator<hstl::unique_ptr<int>>> ptrs;
+  for (int i = 0; i < 1000; ++i) {
+    ptrs.push_back(hstl::make_unique<int>(i));
+  }
+  ptrs.reserve(5000);
+  ptrs.emplace_back();
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ(*ptrs[i], i);
+  }
+  ASSERT_EQ(ptrs.back().get(), nullptr);
+
+  // 新内存 + memcpy
+  hstl::vector<hstl::shared_ptr<int>> shared;
+  auto first = hstl::make_shared<int>(1);
+  for (int i = 0; i < 100; ++i) {
+    shared.push_back(first);
+  }
+  shared.insert(shared.begin() + 50, size_t(100), hstl::make_shared<int>(2));
+  ASSERT_EQ(first.use_count(), 101);
+  ASSERT_EQ(*shared[149], 2);
+  shared.clear();
+  ASSERT_EQ(first.use_count(), 1);
+
+  // 扩容时插入的元素引用vector中的元素
+  hstl::vector<int, hstl::malloc_allocator<int>> ints;
+  ints.push_back(7);
+  for (int i = 0; i < 100; ++i) {
+    ints.push_back(ints[0]);
+  }
+  ints.resize(1000, ints[0]);
+  ASSERT_EQ(ints[999], 7);
+
+  // 扩容时在中间插入引用vector中的元素：不可平凡重定位，元素会被移走
+  hstl::vector<std::string> strings{std::string(40, 'a'), std::string(40, 'b')};
+  ASSERT_EQ(strings.size(), strings.capacity());
+  strings.insert(strings.begin() + 1, strings[0]);
+  ASSERT_EQ(strings.size(), 3);
+  ASSERT_EQ(strings[0], std::string(40, 'a'));
+  ASSERT_EQ(strings[1], std::string(40, 'a'));
+  ASSERT_EQ(strings[2], std::string(40, 'b'));
+  strings.shrink_to_fit();
+  strings.emplace(strings.begin(), strings[2]);
+  ASSERT_EQ(strings[0], std::string(40, 'b'));
+  ASSERT_EQ(strings[3], std::string(40, 'b'));
+}